@@ -24,36 +24,187 @@
  */
 
 #include "AD9833.h"
+#include <string.h>
+
+uint32_t AD9833 :: powerUpMicros = AD9833_POWERUP_MICROS;
+uint32_t AD9833 :: resetMicros = AD9833_RESET_MICROS;
+
+#ifdef AD9833_INSTRUMENT
+AD9833Stats AD9833 :: stats;
+volatile uint8_t AD9833StatsScope :: depth = 0;
+#endif
+
+/*
+ * Precompute the reciprocal of referenceFrequency so SetFrequency only
+ * needs an integer multiply and shift. recip is scaled to use as many
+ * of its 32 bits as possible, so the estimate it gives is at most one
+ * word low (see AD9833FineWord).
+ */
+AD9833Reference :: AD9833Reference ( uint32_t referenceFrequency ) {
+	owned = false;
+	Set(referenceFrequency);
+}
+
+void AD9833Reference :: Set ( uint32_t referenceFrequency ) {
+	/* TODO: The minimum resolution and max frequency are determined by
+	 * by referenceFrequency. We should calculate these values and use
+	 * them during setFrequency. The problem is if the user programs a
+	 * square wave at refFrequency/2, then changes the waveform to sine.
+	 * The sine wave will not have enough points?
+	 */
+	if ( referenceFrequency == 0 )			// Not a clock; avoid dividing by 0
+		referenceFrequency = AD9833_DEFAULT_REFERENCE;
+	frequency = referenceFrequency;
+	recipShift = 0;
+	while ( recipShift < 32 &&
+			((1ULL << (29 + recipShift)) / frequency) <= 0xFFFFFFFFULL )
+		recipShift++;
+	recip = (1ULL << (28 + recipShift)) / frequency;
+}
+
+/*
+ * Devices made with the same reference frequency share one entry. Once
+ * the table is full each device gets its own, which is never shared.
+ */
+const AD9833Reference *AD9833Reference :: Find ( uint32_t referenceFrequency ) {
+	if ( referenceFrequency == 0 ) referenceFrequency = AD9833_DEFAULT_REFERENCE;
+	static AD9833Reference table[AD9833_REFERENCE_SLOTS];	// Made on first use
+	static uint8_t used = 0;
+	for ( uint8_t i = 0; i < used; i++ )
+		if ( table[i].frequency == referenceFrequency ) return &table[i];
+	if ( used == AD9833_REFERENCE_SLOTS ) {
+		AD9833Reference *made = new AD9833Reference(referenceFrequency);
+		made->owned = true;
+		return made;
+	}
+	table[used].Set(referenceFrequency);
+	return &table[used++];
+}
+
+/*
+ * The word is estimated from the 24 bit mantissa of the float times the
+ * reciprocal, which never comes out above the exact word, then checked
+ * against floor(frequencyHz * 2^28), which is exact in 64 bits, and
+ * corrected. So the input is not rounded to a fixed point step first,
+ * and the word is right for every reference frequency. Below
+ * 2^recipShift Hz (4 to 8 times refHz, so every frequency from a
+ * 3.2 MHz reference up) the check is done in 32 bits.
+ */
+uint64_t AD9833FineWord ( float frequencyHz, uint32_t refHz, uint32_t recip,
+		uint8_t recipShift ) {
+	uint32_t bits;
+	memcpy(&bits,&frequencyHz,sizeof(bits));
+	// Positive floats order as integers. 0, denormals (word 0 anyway),
+	// negative numbers and NaN give 0.
+	if ( bits < 0x00800000UL || bits > 0x7F800000UL ) return 0;
+	if ( bits > FREQ_MAX_BITS ) bits = FREQ_MAX_BITS;
+
+	// frequencyHz = mantissa * 2^exponent, exponent -149 to 0
+	uint32_t mantissa = (bits & 0x7FFFFF) | 0x800000;
+	int16_t exponent = (int16_t)(bits >> 23) - 150;
+	uint64_t product = (uint64_t)mantissa * recip;
+	int16_t shift = recipShift - exponent;
+	uint64_t word = shift < 64 ? product >> shift : 0;
+	uint16_t fraction;
+	if ( shift < FREQ_FINE_BITS ) fraction = (uint16_t)(product << (FREQ_FINE_BITS - shift));
+	else if ( shift < 64 + FREQ_FINE_BITS ) fraction = (uint16_t)(product >> (shift - FREQ_FINE_BITS));
+	else fraction = 0;
+
+	// floor(frequencyHz * 2^28), and what is left over after word
+	int16_t scale = 28 + exponent;
+	if ( shift >= 24 && refHz < 0x80000000UL ) {
+		// frequencyHz < 2^recipShift: word is at most one low, so the
+		// remainder is below 2 * refHz and its low 32 bits are all of it.
+		// This saves a 64 bit multiply (a libgcc call on AVR).
+		uint32_t scaled = scale >= 0 ? mantissa << scale :
+			scale > -24 ? mantissa >> -scale : 0;
+		if ( scaled - (uint32_t)word * refHz >= refHz ) {
+			word++;
+			fraction = 0;
+		}
+		return (word << FREQ_FINE_BITS) | fraction;
+	}
+	uint64_t scaled = scale >= 0 ? (uint64_t)mantissa << scale :
+		scale > -24 ? mantissa >> -scale : 0;
+	uint64_t remainder = scaled - word * refHz;
+	if ( remainder >= refHz ) {
+		// One word low. More only for frequencies far above refHz.
+		word++;
+		remainder -= refHz;
+		if ( remainder >= refHz ) word += remainder / refHz;
+		fraction = 0;
+	}
+	return (word << FREQ_FINE_BITS) | fraction;
+}
 
 /*
  * Create an AD9833 object
  */
 AD9833 :: AD9833 ( uint8_t FNCpin, uint32_t referenceFrequency ) {
-	// Pin used to enable SPI communication (active LOW)
+	SetPin(FNCpin);
+	transport = NULL;
+	Init(AD9833Reference::Find(referenceFrequency));
+}
+
+AD9833 :: AD9833 ( uint8_t FNCpin, const AD9833Reference &reference ) {
+	SetPin(FNCpin);
+	transport = NULL;
+	Init(&reference);
+}
+
+/*
+ * Create an AD9833 object that sends its words through a transport
+ */
+AD9833 :: AD9833 ( AD9833Transport &transport, uint32_t referenceFrequency ) {
+	this->transport = &transport;
+	Init(AD9833Reference::Find(referenceFrequency));
+}
+
+AD9833 :: AD9833 ( AD9833Transport &transport, const AD9833Reference &reference ) {
+	this->transport = &transport;
+	Init(&reference);
+}
+
+/*
+ * Pin used to enable SPI communication (active LOW)
+ */
+void AD9833 :: SetPin ( uint8_t FNCpin ) {
 #ifdef FNC_PIN
+	(void)FNCpin;
 	pinMode(FNC_PIN,OUTPUT);
 #else
 	this->FNCpin = FNCpin;
 	pinMode(FNCpin,OUTPUT);
 #endif
 	WRITE_FNCPIN(HIGH);
+}
+
+/*
+ * Settings shared by the constructors. Integer only, so a sketch that
+ * only uses the word functions does not link the float library.
+ */
+void AD9833 :: Init ( const AD9833Reference *reference ) {
+	this->reference = reference;
+#ifndef FNC_PIN
+	if ( transport ) FNCpin = 0;		// Not used, the transport owns FSYNC
+#endif
 
-	/* TODO: The minimum resolution and max frequency are determined by
-	 * by referenceFrequency. We should calculate these values and use
-	 * them during setFrequency. The problem is if the user programs a
-	 * square wave at refFrequency/2, then changes the waveform to sine.
-	 * The sine wave will not have enough points?
-	 */
-	refFrequency = referenceFrequency;
-	
 	// Setup some defaults
 	DacDisabled = false;
 	IntClkDisabled = false;
 	outputEnabled = false;
-	waveForm0 = waveForm1 = SINE_WAVE;
-	frequency0 = frequency1 = 1000;		// 1 KHz sine wave to start
-	phase0 = phase1 = 0.0;				// 0 phase
+	waveForm0 = waveForm1 = SINE_WAVE & WAVEFORM_BITS;
+	// 1 KHz sine wave to start
+	freqWord[0] = freqWord[1] = (uint32_t)(FineWord(1000.0f) >> FREQ_FINE_BITS) &
+		FREQ_WORD_MASK;
+	freqFrac[0] = freqFrac[1] = 0;
+	phaseFine[0] = phaseFine[1] = 0;	// 0 phase
 	activeFreq = REG0; activePhase = REG0;
+	freqMode = B28_CMD >> FREQ_MODE_SHIFT;	// Both halves per write
+	shadowValid = 0;					// Chip contents are unknown
+	updateCount = updateDepth = 0;
+	startState = START_READY;
+	startPending = false;
 }
 
 /*
@@ -61,9 +212,65 @@ AD9833 :: AD9833 ( uint8_t FNCpin, uint32_t referenceFrequency ) {
  * Start SPI and place the AD9833 in the RESET state
  */
 void AD9833 :: Begin ( void ) {
-	SPI.begin();
-	delay(100);
-	Reset();	// Hold in RESET until first WriteRegister command
+	BeginAsync();
+	WaitMicros(powerUpMicros);
+	Poll();					// Sends RESET
+	WaitMicros(resetMicros);
+	Poll();
+}
+
+/*
+ * Begin without waiting. The power up delay is timed from here.
+ */
+void AD9833 :: BeginAsync ( void ) {
+	shadowValid = 0;	// Chip may have been power cycled
+	AD9833_DEBUG_PIN_BEGIN();
+	if ( transport ) transport->Begin();
+	else SPI.begin();
+	startState = START_POWER_UP;
+	startMicros = micros();
+}
+
+/*
+ * Start (or restart) the RESET hold without waiting
+ */
+void AD9833 :: ResetAsync ( void ) {
+	AD9833_STATS_TIME(STAT_RESET);
+	if ( startState == START_POWER_UP ) return;		// RESET is coming
+	startState = START_READY;
+	// Always sent, even if the chip is already in RESET, since it
+	// also restarts the phase accumulator.
+	WriteRegister(RESET_CMD);
+	FlushUpdate();		// RESET goes out now, even inside BeginUpdate
+	controlShadow = RESET_CMD;
+	shadowValid |= SHADOW_CONTROL;
+	startState = START_RESET;
+	startMicros = micros();
+}
+
+/*
+ * Move BeginAsync / ResetAsync along. When the chip becomes ready, the
+ * settings changed while waiting are sent in one burst.
+ */
+bool AD9833 :: Poll ( void ) {
+	if ( startState == START_READY ) return true;
+	if ( startState == START_POWER_UP ) {
+		if ( micros() - startMicros < powerUpMicros ) return false;
+		startState = START_READY;		// So ResetAsync sends RESET
+		ResetAsync();
+	}
+	if ( micros() - startMicros < resetMicros ) return false;
+	startState = START_READY;
+	if ( startPending ) {
+		startPending = false;
+		WriteAllRegisters();
+	}
+	return true;
+}
+
+void AD9833 :: SetStartupDelays ( uint32_t powerUpMicros, uint32_t resetMicros ) {
+	AD9833::powerUpMicros = powerUpMicros;
+	AD9833::resetMicros = resetMicros;
 }
 
 /*
@@ -75,10 +282,13 @@ void AD9833 :: Begin ( void ) {
 void AD9833 :: ApplySignal ( WaveformType waveType,
 		Registers freqReg, float frequencyInHz,
 		Registers phaseReg, float phaseInDeg ) {
+	AD9833_STATS_TIME(STAT_APPLY_SIGNAL);
+	BeginUpdate();			// Send everything in one SPI transaction
 	SetFrequency ( freqReg, frequencyInHz );
 	SetPhase ( phaseReg, phaseInDeg );
 	SetWaveform ( freqReg, waveType );
 	SetOutputSource ( freqReg, phaseReg );
+	EndUpdate();
 }
 
 /***********************************************************************
@@ -126,14 +336,41 @@ D0	Reserved. Must be 0.
  * state.
  */
 void AD9833 :: Reset ( void ) {
-	WriteRegister(RESET_CMD);
-	delay(15);
+	ResetAsync();
+	WaitMicros(resetMicros);
+	Poll();
+}
+
+/*
+ * Retune without a half updated output. SetFrequency and SetPhase on
+ * the live registers take effect one SPI word at a time, so the output
+ * briefly has the new frequency with the old phase. Here those writes
+ * go to the standby set, and only the last word, the control word that
+ * swaps FSEL and PSEL, changes the output.
+ */
+void AD9833 :: Retune ( float frequencyInHz, float phaseInDeg ) {
+	AD9833_STATS_TIME(STAT_RETUNE);
+	Registers standby = activeFreq ? REG0 : REG1;
+	if ( standby == REG0 ) waveForm0 = waveForm1;	// Keep the waveform
+	else waveForm1 = waveForm0;
+
+	BeginUpdate();
+	SetFrequency(standby,frequencyInHz);
+	SetPhase(standby,phaseInDeg);
+	activeFreq = activePhase = standby == REG1;
+	WriteControlRegister();
+	EndUpdate();
+}
+
+Registers AD9833 :: GetActiveRegister ( void ) {
+	return activeFreq ? REG1 : REG0;
 }
 
 /*
  *  Set the specified frequency register with the frequency (in Hz)
  */
 void AD9833 :: SetFrequency ( Registers freqReg, float frequency ) {
+	AD9833_STATS_TIME(STAT_SET_FREQUENCY);
 	// TODO: calculate max frequency based on refFrequency.
 	// Use the calculations for sanity checks on numbers.
 	// Sanity check on frequency: Square - refFrequency / 2
@@ -142,36 +379,102 @@ void AD9833 :: SetFrequency ( Registers freqReg, float frequency ) {
 		frequency = 12.5e6;
 	if ( frequency < 0.0 ) frequency = 0.0;
 	
-	// Save frequency for use by IncrementFrequency function
-	if ( freqReg == REG0 ) frequency0 = frequency;
-	else frequency1 = frequency;
+	// Same encoding as FrequencyToWord, but the FREQ_FINE_BITS below
+	// the word are kept for IncrementFrequency
+	uint8_t index = freqReg == REG0 ? 0 : 1;
+	uint64_t fineWord = FineWord(frequency);
+	freqFrac[index] = (uint16_t)fineWord;
 	
-	int32_t freqWord = (frequency * pow2_28) / (float)refFrequency;
-	int16_t upper14 = (int16_t)((freqWord & 0xFFFC000) >> 14), 
-			lower14 = (int16_t)(freqWord & 0x3FFF);
+	WriteFrequencyWord(index,(uint32_t)(fineWord >> FREQ_FINE_BITS) &
+		FREQ_WORD_MASK);
+}
 
-	// Which frequency register are we updating?
-	uint16_t reg = freqReg == REG0 ? FREQ0_WRITE_REG : FREQ1_WRITE_REG;
-	lower14 |= reg;
-	upper14 |= reg;   
+/*
+ * Set the specified frequency register with a raw 28 bit frequency
+ * word. The output frequency is freqWord * refFrequency / 2^28. Values
+ * above 2^27 (refFrequency / 2) alias and are not checked.
+ */
+void AD9833 :: SetFrequencyWord ( Registers freqReg, uint32_t freqWord ) {
+	AD9833_STATS_TIME(STAT_FREQUENCY_WORD);
+	uint8_t index = freqReg == REG0 ? 0 : 1;
+	freqFrac[index] = 0;
 
-	// I do not reset the registers during write. It seems to remove
-	// 'glitching' on the outputs.
-	WriteControlRegister();
-	// Control register has already been setup to accept two frequency
-	// writes, one for each 14 bit part of the 28 bit frequency word
-	WriteRegister(lower14);			// Write lower 14 bits to AD9833
-	WriteRegister(upper14);			// Write upper 14 bits to AD9833
+	WriteFrequencyWord(index,freqWord & FREQ_WORD_MASK);
+}
+
+/*
+ * Add wordInc (which may be negative) to the 28 bit frequency word in
+ * freqReg, wrapping around at 2^28. Integer only, so repeated steps
+ * never drift.
+ */
+void AD9833 :: IncrementFrequencyWord ( Registers freqReg, int32_t wordInc ) {
+	AD9833_STATS_TIME(STAT_FREQUENCY_WORD);
+	uint8_t index = freqReg == REG0 ? 0 : 1;
+	freqFrac[index] = 0;
+	WriteFrequencyWord(index,(freqWord[index] + wordInc) & FREQ_WORD_MASK);
+}
+
+/*
+ * Set a frequency register from its already encoded LSB and MSB writes
+ * (FREQ0_WRITE_REG or FREQ1_WRITE_REG plus 14 bits each), such as the
+ * entries of a frequency plan table (see AD9833FreqPlan.h). The
+ * register is taken from lsbWord.
+ */
+void AD9833 :: SetFrequencyWords ( uint16_t lsbWord, uint16_t msbWord ) {
+	AD9833_STATS_TIME(STAT_FREQUENCY_WORD);
+	uint8_t index = (lsbWord & FREQ1_WRITE_REG) ? 1 : 0;
+	freqFrac[index] = 0;
+
+	WriteFrequencyWords(index,
+		((uint32_t)(msbWord & 0x3FFF) << 14) | (lsbWord & 0x3FFF),
+		lsbWord,msbWord);
+}
+
+/*
+ * Return the 28 bit frequency word programmed in a register
+ */
+uint32_t AD9833 :: GetFrequencyWord ( Registers freqReg ) {
+	return freqWord[freqReg == REG0 ? 0 : 1];
+}
+
+/*
+ * Convert a frequency (in Hz) to a 28 bit frequency word using the
+ * precomputed reciprocal of refFrequency, with no float math (see
+ * AD9833FineWord). The result is floor(frequency * 2^28 / refFrequency),
+ * truncated as the AD9833 does with its own phase accumulator.
+ * Negative frequencies give 0.
+ */
+uint32_t AD9833 :: FrequencyToWord ( float frequency ) {
+	return (uint32_t)(FineWord(frequency) >> FREQ_FINE_BITS) & FREQ_WORD_MASK;
 }
 
 /*
- * Increment the specified frequency register with the frequency (in Hz)
+ * Increment the specified frequency register with the frequency (in Hz).
+ * The frequency word is kept with FREQ_FINE_BITS of fraction, and the
+ * increment is converted to the same units, so repeated steps add up
+ * as integers rather than being re-encoded from a float each time.
  */
 void AD9833 :: IncrementFrequency ( Registers freqReg, float freqIncHz ) {
+	AD9833_STATS_TIME(STAT_INCREMENT_FREQUENCY);
 	// Add/subtract a value from the current frequency programmed in
 	// freqReg by the amount given
-	float frequency = (freqReg == REG0) ? frequency0 : frequency1;
-	SetFrequency(freqReg,frequency+freqIncHz);
+	uint8_t index = freqReg == REG0 ? 0 : 1;
+	int64_t fineWord = ((int64_t)freqWord[index] << FREQ_FINE_BITS) |
+		freqFrac[index];
+
+	// freqIncHz * 2^28 / refFrequency, in 1/2^FREQ_FINE_BITS words
+	if ( freqIncHz > 12.5e6 ) freqIncHz = 12.5e6;
+	else if ( freqIncHz < -12.5e6 ) freqIncHz = -12.5e6;
+	float fineInc = ldexp(freqIncHz * (float)reference->recip,
+		FREQ_FINE_BITS - reference->recipShift);
+	fineWord += (int64_t)(fineInc < 0 ? fineInc - 0.5 : fineInc + 0.5);
+
+	// Same limits as SetFrequency
+	int64_t maxFineWord = FineWord(12.5e6f);
+	if ( fineWord > maxFineWord ) fineWord = maxFineWord;
+	if ( fineWord < 0 ) fineWord = 0;
+	freqFrac[index] = (uint16_t)fineWord;
+	WriteFrequencyWord(index,(uint32_t)(fineWord >> FREQ_FINE_BITS));
 }
 
 /*
@@ -179,34 +482,69 @@ void AD9833 :: IncrementFrequency ( Registers freqReg, float freqIncHz ) {
  * The output signal will be phase shifted by 2π/4096 x PHASEREG
  */
 void AD9833 :: SetPhase ( Registers phaseReg, float phaseInDeg ) {
+	AD9833_STATS_TIME(STAT_SET_PHASE);
 	// Sanity checks on input
 	phaseInDeg = fmod(phaseInDeg,360);
 	if ( phaseInDeg < 0 ) phaseInDeg += 360;
 	
 	// Phase is in float degrees ( 0.0 - 360.0 )
-	// Convert to a number 0 to 4096 where 4096 = 0 by masking
-	uint16_t phaseVal = (uint16_t)(BITS_PER_DEG * phaseInDeg) & 0x0FFF;
-	phaseVal |= PHASE_WRITE_CMD;
-	
-	// Save phase for use by IncrementPhase function
-	if ( phaseReg == REG0 )	{
-		phase0 = phaseInDeg;
-	}
-	else {
-		phase1 = phaseInDeg;
-		phaseVal |= PHASE1_WRITE_REG;
-	}
-	WriteRegister(phaseVal);
+	// Convert to a number 0 to 4096 where 4096 = 0 by masking. The
+	// PHASE_FINE_BITS below that are kept for IncrementPhase. Scaling
+	// by a power of two is exact, so the upper 12 bits are the same as
+	// (uint16_t)(BITS_PER_DEG * phaseInDeg).
+	// A tiny negative phase comes out of the fmod as exactly 360, which
+	// is 2^32 here: convert through 64 bits so that it masks to 0.
+	uint8_t index = phaseReg == REG0 ? 0 : 1;
+	phaseFine[index] = (uint32_t)(int64_t)(BITS_PER_DEG * phaseInDeg *
+		(1UL << PHASE_FINE_BITS));
+	WritePhaseWord(index);
+}
+
+/*
+ * Set the specified phase register with a raw 12 bit phase word
+ * (phase = phaseWord * 360 / 4096 degrees)
+ */
+void AD9833 :: SetPhaseWord ( Registers phaseReg, uint16_t phaseWord ) {
+	AD9833_STATS_TIME(STAT_PHASE_WORD);
+	uint8_t index = phaseReg == REG0 ? 0 : 1;
+	phaseFine[index] = (uint32_t)(phaseWord & 0x0FFF) << PHASE_FINE_BITS;
+	WritePhaseWord(index);
+}
+
+/*
+ * Return the 12 bit phase word programmed in a register
+ */
+uint16_t AD9833 :: GetPhaseWord ( Registers phaseReg ) {
+	return phaseFine[phaseReg == REG0 ? 0 : 1] >> PHASE_FINE_BITS;
 }
 
 /*
- * Increment the specified phase register by the phase (in degrees)
+ * Increment the specified phase register by the phase (in degrees).
+ * The phase is kept in 1/2^32 of a turn, which wraps around by itself,
+ * so the stored phase is never re-encoded from a float.
  */
 void AD9833 :: IncrementPhase ( Registers phaseReg, float phaseIncDeg ) {
+	AD9833_STATS_TIME(STAT_INCREMENT_PHASE);
 	// Add/subtract a value from the current phase programmed in
 	// phaseReg by the amount given
-	float phase = (phaseReg == REG0) ? phase0 : phase1;
-	SetPhase(phaseReg,phase + phaseIncDeg);
+	if ( phaseIncDeg >= 360 || phaseIncDeg <= -360 )
+		phaseIncDeg = fmod(phaseIncDeg,360);
+	float fineInc = BITS_PER_DEG * phaseIncDeg * (1UL << PHASE_FINE_BITS);
+	uint8_t index = phaseReg == REG0 ? 0 : 1;
+	phaseFine[index] += (uint32_t)(int64_t)(fineInc < 0 ? fineInc - 0.5 :
+		fineInc + 0.5);
+	WritePhaseWord(index);
+}
+
+/*
+ * Add wordInc (which may be negative) to the 12 bit phase word in
+ * phaseReg, wrapping around at 4096. Integer only.
+ */
+void AD9833 :: IncrementPhaseWord ( Registers phaseReg, int16_t wordInc ) {
+	AD9833_STATS_TIME(STAT_PHASE_WORD);
+	uint8_t index = phaseReg == REG0 ? 0 : 1;
+	phaseFine[index] += (uint32_t)(int32_t)wordInc << PHASE_FINE_BITS;
+	WritePhaseWord(index);
 }
 
 /*
@@ -214,11 +552,12 @@ void AD9833 :: IncrementPhase ( Registers phaseReg, float phaseIncDeg ) {
  * SINE_WAVE, TRIANGLE_WAVE, SQUARE_WAVE, HALF_SQUARE_WAVE
  */
 void AD9833 :: SetWaveform (  Registers waveFormReg, WaveformType waveType ) {
+	AD9833_STATS_TIME(STAT_CONTROL);
 	// TODO: Add more error checking?
 	if ( waveFormReg == REG0 )
-		waveForm0 = waveType;
+		waveForm0 = waveType & WAVEFORM_BITS;
 	else
-		waveForm1 = waveType;
+		waveForm1 = waveType & WAVEFORM_BITS;
 	WriteControlRegister();
 }
 
@@ -227,6 +566,7 @@ void AD9833 :: SetWaveform (  Registers waveFormReg, WaveformType waveType ) {
  * EnableOutput(true). See the Reset function description.
  */
 void AD9833 :: EnableOutput ( bool enable ) {
+	AD9833_STATS_TIME(STAT_CONTROL);
 	outputEnabled = enable;
 	WriteControlRegister();
 }
@@ -237,13 +577,37 @@ void AD9833 :: EnableOutput ( bool enable ) {
  * register as freqReg.
  */
 void AD9833 :: SetOutputSource ( Registers freqReg, Registers phaseReg ) {
+	AD9833_STATS_TIME(STAT_CONTROL);
 	// TODO: Add more error checking?
-	activeFreq = freqReg;
+	activeFreq = freqReg == REG1;
 	if ( phaseReg == SAME_AS_REG0 )	activePhase = activeFreq;
-	else activePhase = phaseReg;
+	else activePhase = phaseReg == REG1;
 	WriteControlRegister();
 }
 
+/*
+ * Hold register writes until CommitUpdate, so several frequency, phase
+ * and control changes go out as one SPI transaction, e.g.
+ *		gen.BeginUpdate();
+ *		gen.SetFrequency(REG1,2000);
+ *		gen.SetPhase(REG1,90);
+ *		gen.SetOutputSource(REG1);
+ *		gen.CommitUpdate();
+ * Calls may be nested; only the outermost CommitUpdate sends. Reset()
+ * is not held back.
+ */
+void AD9833 :: BeginUpdate ( void ) {
+	updateDepth++;
+}
+
+/*
+ * Send the register writes held since BeginUpdate
+ */
+void AD9833 :: CommitUpdate ( void ) {
+	AD9833_STATS_TIME(STAT_COMMIT_UPDATE);
+	EndUpdate();
+}
+
 //---------- LOWER LEVEL FUNCTIONS NOT NORMALLY NEEDED -------------
 
 /*
@@ -252,6 +616,7 @@ void AD9833 :: SetOutputSource ( Registers freqReg, Registers phaseReg ) {
  * TODO: ?? IS THIS TRUE ??
  */
 void AD9833 :: SleepMode ( bool enable ) {
+	AD9833_STATS_TIME(STAT_CONTROL);
 	DacDisabled = enable;
 	IntClkDisabled = enable;
 	WriteControlRegister();
@@ -262,6 +627,7 @@ void AD9833 :: SleepMode ( bool enable ) {
  * setting by Waveform type, or via the SleepMode function
  */
 void AD9833 :: DisableDAC ( bool enable ) {
+	AD9833_STATS_TIME(STAT_CONTROL);
 	DacDisabled = enable;
 	WriteControlRegister();	
 }
@@ -271,34 +637,113 @@ void AD9833 :: DisableDAC ( bool enable ) {
  * previous clock setting by the SleepMode function
  */
 void AD9833 :: DisableInternalClock ( bool enable ) { 
+	AD9833_STATS_TIME(STAT_CONTROL);
 	IntClkDisabled = enable;
 	WriteControlRegister();	
 }
 
+/*
+ * Return the control word that would output freqReg / phaseReg with
+ * the current waveform, RESET, DAC and clock settings. If phaseReg is
+ * not supplied, it defaults to the same register as freqReg. Used to
+ * precompute words for fast switching from an interrupt.
+ */
+uint16_t AD9833 :: GetControlWord ( Registers freqReg, Registers phaseReg ) {
+	uint16_t waveForm;
+	if ( phaseReg == SAME_AS_REG0 ) phaseReg = freqReg;
+	if ( freqReg == REG0 )
+		waveForm = waveForm0;
+	else
+		waveForm = waveForm1 | FREQ1_OUTPUT_REG;
+	if ( phaseReg != REG0 )
+		waveForm |= PHASE1_OUTPUT_REG;
+	if ( !outputEnabled )
+		waveForm |= RESET_CMD;
+	if ( DacDisabled )
+		waveForm |= DISABLE_DAC;
+	if ( IntClkDisabled )
+		waveForm |= DISABLE_INT_CLK;
+	// How the next frequency register write is taken
+	return waveForm | ((uint16_t)freqMode << FREQ_MODE_SHIFT);
+}
+
+/*
+ * Write the control register, unless the chip already holds controlWord
+ */
+inline void AD9833 :: WriteControl ( uint16_t controlWord ) {
+	// Skip the write if the chip already has this control word
+	if ( (shadowValid & SHADOW_CONTROL) && controlShadow == controlWord ) {
+		AD9833_STATS_REDUNDANT(STAT_CONTROL_REG);
+		return;
+	}
+	controlShadow = controlWord;
+	shadowValid |= SHADOW_CONTROL;
+	WriteRegister ( controlWord );
+}
+
+/*
+ * Write a control word made by GetControlWord, unless the chip already
+ * holds it. This does not change the settings kept by the library; the
+ * next call that writes the control register puts them back.
+ */
+void AD9833 :: WriteControlWord ( uint16_t controlWord ) {
+	AD9833_STATS_TIME(STAT_CONTROL);
+	WriteControl(controlWord);
+}
+
 // ------------ STATUS / INFORMATION FUNCTIONS -------------------
+/*
+ * True while the transport is still sending earlier writes. Always
+ * false for the SPI library, which sends before returning.
+ */
+bool AD9833 :: Busy ( void ) {
+	return transport != NULL && transport->Busy();
+}
+
 /*
  * Return actual frequency programmed
  */
 float AD9833 :: GetActualProgrammedFrequency ( Registers reg ) {
-	float frequency = reg == REG0 ? frequency0 : frequency1;
-	int32_t freqWord = (uint32_t)((frequency * pow2_28) / (float)refFrequency) & 0x0FFFFFFFUL;
-	return (float)freqWord * (float)refFrequency / (float)pow2_28;
+	return (float)GetFrequencyWord(reg) * (float)reference->frequency / (float)pow2_28;
 }
 
 /*
  * Return actual phase programmed
  */
 float AD9833 :: GetActualProgrammedPhase ( Registers reg ) {
-	float phase = reg == REG0 ? phase0 : phase1;
-	uint16_t phaseVal = (uint16_t)(BITS_PER_DEG * phase) & 0x0FFF;
-	return (float)phaseVal / BITS_PER_DEG;
+	return (float)GetPhaseWord(reg) / BITS_PER_DEG;
 }
 
 /*
  * Return frequency resolution
  */
 float AD9833 :: GetResolution ( void ) {
-	return (float)refFrequency / (float)pow2_28;
+	return (float)reference->frequency / (float)pow2_28;
+}
+
+/*
+ * Return the reference (MCLK) frequency
+ */
+uint32_t AD9833 :: GetReferenceFrequency ( void ) {
+	return reference->frequency;
+}
+
+/*
+ * Switch this device to another reference. Other devices sharing the
+ * old one are not affected. A reference that Find allocated for this
+ * device alone is changed in place, so repeated calibration does not
+ * allocate again.
+ */
+void AD9833 :: SetReferenceFrequency ( uint32_t referenceFrequency ) {
+	if ( reference->owned ) {
+		const_cast<AD9833Reference *>(reference)->Set(referenceFrequency);
+		return;
+	}
+	reference = AD9833Reference::Find(referenceFrequency);
+}
+
+void AD9833 :: SetReference ( const AD9833Reference &reference ) {
+	this->reference = &reference;
 }
 
 // --------------------- PRIVATE FUNCTIONS --------------------------
@@ -307,58 +752,237 @@ float AD9833 :: GetResolution ( void ) {
  * Write control register. Setup register based on defined states
  */
 void AD9833 :: WriteControlRegister ( void ) {
-	uint16_t waveForm;
-	// TODO: can speed things up by keeping a writeReg0 and writeReg1
-	// that presets all bits during the various setup function calls
-	// rather than setting flags. Then we could just call WriteRegister
-	// directly.
-	if ( activeFreq == REG0 ) {
-		waveForm = waveForm0;
-		waveForm &= ~FREQ1_OUTPUT_REG;
+	WriteControl(GetControlWord(activeFreq ? REG1 : REG0,activePhase ? REG1 : REG0));
+}
+
+/*
+ * Frequency word, with FREQ_FINE_BITS of fraction, for a frequency in
+ * Hz on this device's reference. See FrequencyToWord.
+ */
+uint64_t AD9833 :: FineWord ( float frequency ) {
+	return AD9833FineWord(frequency,reference->frequency,reference->recip,
+		reference->recipShift);
+}
+
+/*
+ * Load a phase register (index 0 or 1) from phaseFine, unless the chip
+ * already holds that phase word
+ */
+void AD9833 :: WritePhaseWord ( uint8_t index ) {
+	uint16_t phaseVal = (phaseFine[index] >> PHASE_FINE_BITS) | PHASE_WRITE_CMD;
+	if ( index ) phaseVal |= PHASE1_WRITE_REG;
+
+	// Nothing more to do if the chip already holds this word
+	uint8_t shadowBit = SHADOW_PHASE0 << index;
+	if ( (shadowValid & shadowBit) && phaseShadow[index] == phaseVal ) {
+		AD9833_STATS_REDUNDANT(index ? STAT_PHASE1_REG : STAT_PHASE0_REG);
+		return;
 	}
-	else {
-		waveForm = waveForm1;
-		waveForm |= FREQ1_OUTPUT_REG;
+	phaseShadow[index] = phaseVal;
+	shadowValid |= shadowBit;
+	WriteRegister(phaseVal);
+}
+
+/*
+ * Load a frequency register (index 0 or 1) with a 28 bit word, unless
+ * the chip already holds it
+ */
+void AD9833 :: WriteFrequencyWord ( uint8_t index, uint32_t freqWord ) {
+	int16_t upper14 = (int16_t)((freqWord & 0xFFFC000) >> 14), 
+			lower14 = (int16_t)(freqWord & 0x3FFF);
+
+	// Which frequency register are we updating?
+	uint16_t reg = index == 0 ? FREQ0_WRITE_REG : FREQ1_WRITE_REG;
+	lower14 |= reg;
+	upper14 |= reg;   
+
+	WriteFrequencyWords(index,freqWord,lower14,upper14);
+}
+
+/*
+ * Load a frequency register with its already encoded LSB and MSB writes.
+ * When the chip is known to hold the register and only one 14 bit half
+ * changes (most steps of a fine sweep), B28 is cleared and HLB selects
+ * that half, so just one frequency word is sent. The control word that
+ * switches mode is only sent when the mode changes.
+ */
+void AD9833 :: WriteFrequencyWords ( uint8_t index, uint32_t freqWord,
+		uint16_t lsbWord, uint16_t msbWord ) {
+	BeginUpdate();					// Control and frequency words together
+
+	uint8_t shadowBit = SHADOW_FREQ0 << index;
+	uint32_t changed = FREQ_WORD_MASK;
+	if ( shadowValid & shadowBit )
+		changed = this->freqWord[index] ^ freqWord;
+	if ( changed == 0 ) {
+		// Nothing more to do, the chip already holds this word
+		AD9833_STATS_REDUNDANT(index ? STAT_FREQ1_REG : STAT_FREQ0_REG);
+		WriteControlRegister();
+		EndUpdate();
+		return;
 	}
-	if ( activePhase == REG0 )
-		waveForm &= ~PHASE1_OUTPUT_REG;
-	else
-		waveForm |= PHASE1_OUTPUT_REG;
-	if ( outputEnabled )
-		waveForm &= ~RESET_CMD;
-	else
-		waveForm |= RESET_CMD;
-	if ( DacDisabled )
-		waveForm |= DISABLE_DAC;
-	else
-		waveForm &= ~DISABLE_DAC;
-	if ( IntClkDisabled )
-		waveForm |= DISABLE_INT_CLK;
-	else
-		waveForm &= ~DISABLE_INT_CLK;
+	this->freqWord[index] = freqWord;
+	shadowValid |= shadowBit;
+
+	uint16_t mode;
+	if ( (changed & 0xFFFC000) == 0 ) mode = 0;			// LSB only
+	else if ( (changed & 0x3FFF) == 0 ) mode = HLB_CMD;	// MSB only
+	else mode = B28_CMD;						// Both, consecutively
+	freqMode = mode >> FREQ_MODE_SHIFT;
+
+	// I do not reset the registers during write. It seems to remove
+	// 'glitching' on the outputs.
+	WriteControlRegister();
+
+	// Control register has already been setup to accept one or two
+	// frequency writes, for the 14 bit parts of the 28 bit frequency word
+	if ( mode != HLB_CMD )
+		WriteRegister(lsbWord);		// Write lower 14 bits to AD9833
+	if ( mode != 0 )
+		WriteRegister(msbWord);		// Write upper 14 bits to AD9833
+	EndUpdate();
+}
 
-	WriteRegister ( waveForm );
+/*
+ * Load every register from the settings in one SPI transaction: RESET
+ * while the frequency and phase registers are written, then the
+ * control word. At most UPDATE_BUFFER_SIZE words.
+ */
+void AD9833 :: WriteAllRegisters ( void ) {
+	BeginUpdate();
+	shadowValid = 0;
+	freqMode = B28_CMD >> FREQ_MODE_SHIFT;
+	WriteControl(GetControlWord(activeFreq ? REG1 : REG0,activePhase ? REG1 : REG0) |
+		RESET_CMD);
+	for ( uint8_t index = 0; index < 2; index++ ) {
+		uint16_t reg = index == 0 ? FREQ0_WRITE_REG : FREQ1_WRITE_REG;
+		WriteRegister((freqWord[index] & 0x3FFF) | reg);
+		WriteRegister(((freqWord[index] >> 14) & 0x3FFF) | reg);
+		shadowValid |= SHADOW_FREQ0 << index;
+		WritePhaseWord(index);
+	}
+	WriteControlRegister();
+	EndUpdate();
+}
+
+/*
+ * Blocking wait used by Begin and Reset
+ */
+void AD9833 :: WaitMicros ( uint32_t micros ) {
+	if ( micros >= 1000 ) delay(micros / 1000);
+	delayMicroseconds(micros % 1000);
 }
 
+/*
+ * Write one word, or hold it if inside BeginUpdate / CommitUpdate.
+ * Until BeginAsync / ResetAsync are done, nothing is sent; Poll sends
+ * the resulting settings.
+ */
 void AD9833 :: WriteRegister ( int16_t dat ) {
-	/*
-	 * We set the mode here, because other hardware may be doing SPI also
-	 */
-	SPI.setDataMode(SPI_MODE2);
+	if ( startState != START_READY ) {
+		startPending = true;
+		return;
+	}
+	if ( updateDepth == 0 ) {
+		uint16_t word = dat;
+		SendWords(&word,1);
+		return;
+	}
+	if ( updateCount == UPDATE_BUFFER_SIZE )
+		FlushUpdate();			// Full. Send what we have so far.
+	updateBuffer[updateCount++] = dat;
+}
+
+/*
+ * CommitUpdate without the timing, for the functions that hold their
+ * own writes together
+ */
+void AD9833 :: EndUpdate ( void ) {
+	if ( updateDepth == 0 ) return;
+	if ( --updateDepth == 0 ) FlushUpdate();
+}
+
+/*
+ * Send any words held by BeginUpdate
+ */
+void AD9833 :: FlushUpdate ( void ) {
+	if ( updateCount == 0 ) return;
+	SendWords(updateBuffer,updateCount);
+	updateCount = 0;
+}
+
+/*
+ * Send a sequence of words in one SPI transaction. FNCpin is held LOW
+ * for the whole sequence; the AD9833 latches every 16th SCLK edge, so
+ * a continuous stream of words is allowed.
+ */
+void AD9833 :: SendWords ( const uint16_t *words, uint8_t count ) {
+	AD9833_STATS_WORDS(stats,words,count);
+	AD9833_DEBUG_PIN_HIGH();
+	if ( transport ) {
+		// Only queued, if asynchronous. If the words were dropped the
+		// chip no longer matches the shadows: skip no later writes.
+		if ( !transport->Write(words,count) )
+			shadowValid = 0;
+		AD9833_DEBUG_PIN_LOW();
+		return;
+	}
+
+	BeginTransaction();
 
 	/* Improve overall switching speed
 	 * Note, the times are for this function call, not the write.
 	 * digitalWrite(FNCpin)			~ 17.6 usec
 	 * digitalWriteFast2(FNC_PIN)	~  8.8 usec
 	 */
-	WRITE_FNCPIN(LOW);		// FNCpin low to write to AD9833
+	SelectChip(true);		// FNCpin low to write to AD9833
+	TransferWords(words,count);
+	SelectChip(false);		// Write done
 
-	//delayMicroseconds(2);	// Some delay may be needed
+	EndTransaction();
+	AD9833_DEBUG_PIN_LOW();
+}
 
-	// TODO: Are we running at the highest clock rate?
-	SPI.transfer(highByte(dat));	// Transmit 16 bits 8 bits at a time
-	SPI.transfer(lowByte(dat));
+/*
+ * Drive FNCpin LOW (select) or HIGH
+ */
+void AD9833 :: SelectChip ( bool select ) {
+	// Constant values keep WRITE_FNCPIN on the fast path for FNC_PIN
+	if ( select ) {
+		WRITE_FNCPIN(LOW);
+	}
+	else {
+		WRITE_FNCPIN(HIGH);
+	}
+}
 
-	WRITE_FNCPIN(HIGH);		// Write done
+/*
+ * Start an SPI transaction at the AD9833 maximum clock rate and mode.
+ * We set the mode here, because other hardware may be doing SPI also.
+ */
+void AD9833 :: BeginTransaction ( void ) {
+#ifdef SPI_HAS_TRANSACTION
+	SPI.beginTransaction(SPISettings(AD9833_SPI_CLOCK,MSBFIRST,SPI_MODE2));
+#else
+	SPI.setDataMode(SPI_MODE2);
+#endif
 }
 
+void AD9833 :: EndTransaction ( void ) {
+#ifdef SPI_HAS_TRANSACTION
+	SPI.endTransaction();
+#endif
+}
+
+/*
+ * Clock out up to UPDATE_BUFFER_SIZE words, MSB first, in one buffered
+ * transfer. The caller frames them with FNCpin.
+ */
+void AD9833 :: TransferWords ( const uint16_t *words, uint8_t count ) {
+	uint8_t buffer[2 * UPDATE_BUFFER_SIZE];
+	for ( uint8_t i = 0; i < count; i++ ) {
+		buffer[2 * i] = highByte(words[i]);
+		buffer[2 * i + 1] = lowByte(words[i]);
+	}
+	SPI.transfer(buffer,2 * count);
+}
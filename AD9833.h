@@ -27,8 +27,20 @@
 
 #include <Arduino.h>
 #include <SPI.h>
+#include "AD9833Transport.h"
 
 //#define FNC_PIN 4			// Define FNC_PIN for fast digital writes
+/*
+ * FNC_PIN applies to every AD9833 object, and the FNCpin given to the
+ * constructor is then ignored. For fast FNC writes on a per object pin
+ * use the AD9833Fast<FNCpin> template in AD9833Fast.h instead.
+ */
+
+//#define AD9833_INSTRUMENT		// Keep word counts and latency histograms
+//#define AD9833_DEBUG_PIN 7		// HIGH during every SPI transaction
+/*
+ * See AD9833Stats.h. Both are off by default and then add no code.
+ */
 
 #ifdef FNC_PIN
 	// Use digitalWriteFast for a speedup
@@ -38,9 +50,27 @@
 	#define WRITE_FNCPIN(Val) digitalWrite(FNCpin,(Val))
 #endif
 
+#define AD9833_SPI_CLOCK	40000000UL	// Maximum SCLK rate of the AD9833
+#define UPDATE_BUFFER_SIZE	8			// Words held by BeginUpdate
+
 #define pow2_28				268435456L	// 2^28 used in frequency word calculation
+#define FREQ_WORD_MASK		0x0FFFFFFFUL	// 28 bit frequency word
+#define FREQ_MAX_BITS		0x4B3EBC20UL	// 12.5e6f, as IEEE 754 bits
+#define FREQ_FINE_BITS		16			// Fraction kept below the word
 #define BITS_PER_DEG		11.3777777777778	// 4096 / 360
+#define PHASE_FINE_BITS		20			// Phase kept in 1/2^32 turn
+
+#define AD9833_POWERUP_MICROS	100000UL	// Begin: supply and MCLK settling
+#define AD9833_RESET_MICROS		15000UL		// Reset: RESET held before use
+
+#define AD9833_DEFAULT_REFERENCE	25000000UL	// Used for a reference of 0
 
+#ifndef AD9833_REFERENCE_SLOTS
+#define AD9833_REFERENCE_SLOTS	2			// Reference frequencies shared by
+#endif										// the uint32_t constructors
+
+#define B28_CMD				0x2000		// Frequency writes are LSB then MSB
+#define HLB_CMD				0x1000		// Without B28: writes go to the MSB
 #define RESET_CMD			0x0100		// Reset enabled (also CMD RESET)
 /*		Sleep mode
  * D7	1 = internal clock is disabled
@@ -50,6 +80,9 @@
 #define DISABLE_DAC			0x0040
 #define	DISABLE_INT_CLK		0x0080
 
+#define WAVEFORM_BITS		0x002A		// OPBITEN, DIV2 and MODE
+#define FREQ_MODE_SHIFT		12			// B28_CMD / HLB_CMD to freqMode
+
 #define PHASE_WRITE_CMD		0xC000		// Setup for Phase write
 #define PHASE1_WRITE_REG	0x2000		// Which phase register
 #define FREQ0_WRITE_REG		0x4000		// 
@@ -57,20 +90,110 @@
 #define PHASE1_OUTPUT_REG	0x0400		// Output is based off REG0/REG1
 #define FREQ1_OUTPUT_REG	0x0800		// ditto
 
+// BeginAsync / ResetAsync states
+#define START_READY			0
+#define START_POWER_UP		1
+#define START_RESET			2
+
+// Which shadow copies of the AD9833 registers hold valid data
+#define SHADOW_CONTROL		0x01
+#define SHADOW_FREQ0		0x02
+#define SHADOW_FREQ1		0x04
+#define SHADOW_PHASE0		0x08
+#define SHADOW_PHASE1		0x10
+
+#include "AD9833Stats.h"
+
 typedef enum { SINE_WAVE = 0x2000, TRIANGLE_WAVE = 0x2002,
 			   SQUARE_WAVE = 0x2028, HALF_SQUARE_WAVE = 0x2020 } WaveformType;
 			   
 typedef enum { REG0, REG1, SAME_AS_REG0 } Registers;
 
+/*
+ * A reference (MCLK) frequency and the reciprocal SetFrequency uses.
+ * Devices hold a pointer to one, so devices on the same clock share it:
+ *	AD9833Reference mclk(25000000UL);
+ *	AD9833 gen0(4,mclk), gen1(5,mclk);
+ * The constructors that take a uint32_t find or make one in a table of
+ * AD9833_REFERENCE_SLOTS (more distinct frequencies are allocated, one
+ * for each device). It must outlive the devices that use it.
+ */
+class AD9833Reference {
+
+public:
+
+	// A referenceFrequency of 0 is taken as AD9833_DEFAULT_REFERENCE
+	explicit AD9833Reference ( uint32_t referenceFrequency );
+
+	// The shared reference for referenceFrequency
+	static const AD9833Reference *Find ( uint32_t referenceFrequency );
+
+	uint32_t		frequency;
+	uint32_t		recip;			// 2^(28+recipShift) / frequency
+	uint8_t			recipShift;
+
+private:
+
+	friend class AD9833;
+
+	AD9833Reference ( void ) { frequency = 0; owned = false; }	// Empty Find slot
+	void			Set ( uint32_t referenceFrequency );
+
+	bool			owned;			// Allocated by Find for one device
+};
+
+/*
+ * The frequency word for frequencyHz, with FREQ_FINE_BITS of fraction
+ * below it, on a reference of refHz with the reciprocal recip and
+ * recipShift (see AD9833Reference). The word is floor(frequencyHz *
+ * 2^28 / refHz), exactly. Integer only: the bits of the float are read
+ * directly. Frequencies above 12.5 MHz are taken as 12.5 MHz, and
+ * negative ones as 0.
+ */
+uint64_t AD9833FineWord ( float frequencyHz, uint32_t refHz, uint32_t recip,
+	uint8_t recipShift );
+
 class AD9833 {
 
+	friend class AD9833Array;	// Shares the SPI bus between devices
+	friend class AD9833Sequence;	// Sends precompiled words
+
 public:
 	
 	AD9833 ( uint8_t FNCpin, uint32_t referenceFrequency = 25000000UL );
 
+	// Send the words through 'transport' (which owns FSYNC) instead of
+	// the SPI library and an FNC pin
+	AD9833 ( AD9833Transport &transport, uint32_t referenceFrequency = 25000000UL );
+
+	// The same, sharing 'reference' with other devices
+	AD9833 ( uint8_t FNCpin, const AD9833Reference &reference );
+	AD9833 ( AD9833Transport &transport, const AD9833Reference &reference );
+
 	// Must be the first command after creating the AD9833 object.
 	void Begin ( void );
 
+	// Non-blocking Begin. Starts SPI and returns at once; Poll() then
+	// sends RESET after the power up delay and reports when the chip is
+	// ready. Calls made meanwhile only update the settings, which go
+	// out together in one SPI transaction when it is ready.
+	void BeginAsync ( void );
+
+	// Non-blocking Reset. See BeginAsync and Poll.
+	void ResetAsync ( void );
+
+	// Advance BeginAsync / ResetAsync. Returns true once the chip is
+	// ready (at once if neither is in progress). Call from loop().
+	bool Poll ( void );
+
+	// Power up (Begin) and RESET hold (Reset) times, in microseconds,
+	// for every AD9833 (they are the board's, not the device's).
+	// Defaults are AD9833_POWERUP_MICROS and AD9833_RESET_MICROS. The
+	// datasheet sets no minimum for either: RESET takes effect within
+	// 8 MCLK cycles, and power up only has to cover the supply and the
+	// MCLK oscillator starting. 0 is allowed.
+	static void SetStartupDelays ( uint32_t powerUpMicros, uint32_t resetMicros );
+
 	// Setup and apply a signal. Note that any calls to EnableOut,
 	// SleepMode, DisableDAC, or DisableInternalClock remain in effect
 	void ApplySignal ( WaveformType waveType, Registers freqReg,
@@ -81,18 +204,59 @@ public:
 	// midscale - digital output at 0. See EnableOutput function
 	void Reset ( void );
 
-	// Update just the frequency in REG0 or REG1
+	// Update just the frequency in REG0 or REG1. If only the upper or
+	// lower 14 bits of the frequency word change, only that half is sent.
 	void SetFrequency ( Registers freqReg, float frequency );
 
 	// Increment the selected frequency register by freqIncHz
 	void IncrementFrequency ( Registers freqReg, float freqIncHz );
 
+	// Glitch free retune: load the frequency and phase into the register
+	// set that is not being output, then switch FSEL and PSEL over to it
+	// with one control word, all in one SPI transaction. The output goes
+	// from the old signal to the new one in a single step. The waveform
+	// is kept; REG0 and REG1 take turns being live.
+	void Retune ( float frequencyInHz, float phaseInDeg = 0.0 );
+
+	// Register set now being output (FSEL)
+	Registers GetActiveRegister ( void );
+
+	// Update the frequency in REG0 or REG1 with a raw 28 bit frequency
+	// word (frequency = freqWord * GetResolution()). No float math.
+	void SetFrequencyWord ( Registers freqReg, uint32_t freqWord );
+
+	// Add wordInc to the 28 bit frequency word, wrapping at 2^28. Integer
+	// only: one add and the SPI write.
+	void IncrementFrequencyWord ( Registers freqReg, int32_t wordInc );
+
+	// Update a frequency register from its already encoded LSB and MSB
+	// writes (including the FREQ0 / FREQ1 prefix)
+	void SetFrequencyWords ( uint16_t lsbWord, uint16_t msbWord );
+
+	// Return the 28 bit frequency word for REG0 or REG1
+	uint32_t GetFrequencyWord ( Registers freqReg );
+
+	// Convert a frequency (in Hz) to a 28 bit frequency word:
+	// floor(frequency * 2^28 / reference frequency), exactly, with no
+	// float math
+	uint32_t FrequencyToWord ( float frequency );
+
 	// Update just the phase in REG0 or REG1
 	void SetPhase ( Registers phaseReg, float phaseInDeg );
 
 	// Increment the selected phase register by phaseIncDeg
 	void IncrementPhase ( Registers phaseReg, float phaseIncDeg );
 
+	// Update the phase in REG0 or REG1 with a raw 12 bit phase word
+	// (phase = phaseWord * 360 / 4096 degrees)
+	void SetPhaseWord ( Registers phaseReg, uint16_t phaseWord );
+
+	// Add wordInc to the 12 bit phase word, wrapping at 4096
+	void IncrementPhaseWord ( Registers phaseReg, int16_t wordInc );
+
+	// Return the 12 bit phase word for REG0 or REG1
+	uint16_t GetPhaseWord ( Registers phaseReg );
+
 	// Set the output waveform for the selected frequency register
 	// SINE_WAVE, TRIANGLE_WAVE, SQUARE_WAVE, HALF_SQUARE_WAVE,
 	void SetWaveform ( Registers waveFormReg, WaveformType waveType );
@@ -112,6 +276,24 @@ public:
 	// Enable / Disable Internal Clock
 	void DisableInternalClock ( bool enable );
 
+	// Return the control word that outputs freqReg / phaseReg with the
+	// current waveform, RESET, DAC and clock settings
+	uint16_t GetControlWord ( Registers freqReg,
+		Registers phaseReg = SAME_AS_REG0 );
+
+	// Write a control word made by GetControlWord (if it changed)
+	void WriteControlWord ( uint16_t controlWord );
+
+	// Hold register writes until CommitUpdate, then send them all in
+	// one SPI transaction. Calls may be nested.
+	void BeginUpdate ( void );
+
+	// Send the register writes held since BeginUpdate
+	void CommitUpdate ( void );
+
+	// True while a transport is still sending earlier writes
+	bool Busy ( void );
+
 	// Return actual frequency programmed in register 
 	float GetActualProgrammedFrequency ( Registers reg );
 
@@ -121,18 +303,85 @@ public:
 	// Return frequency resolution 
 	float GetResolution ( void );
 
+	// Return the reference (MCLK) frequency in Hz
+	uint32_t GetReferenceFrequency ( void );
+
+	// Use another reference frequency (a calibrated one, for example)
+	// for the frequencies set from now on and the ones reported. The
+	// registers keep their words until they are set again. Calling it
+	// again and again allocates at most one reference for the device.
+	void SetReferenceFrequency ( uint32_t referenceFrequency );
+	void SetReference ( const AD9833Reference &reference );
+
+#ifdef AD9833_INSTRUMENT
+	// Word counts and latency histograms since the last Clear, for
+	// all devices together
+	AD9833Stats &GetStats ( void ) { return stats; }
+#endif
+
 private:
 
+	void			SetPin ( uint8_t FNCpin );
+	void			Init ( const AD9833Reference *reference );
 	void 			WriteRegister ( int16_t dat );
+	void			EndUpdate ( void );
+	void			FlushUpdate ( void );
+	void			SendWords ( const uint16_t *words, uint8_t count );
+	void			SelectChip ( bool select );
+	static void		BeginTransaction ( void );
+	static void		EndTransaction ( void );
+	static void		TransferWords ( const uint16_t *words, uint8_t count );
 	void 			WriteControlRegister ( void );
-	uint16_t		waveForm0, waveForm1;
+	void			WriteControl ( uint16_t controlWord );
+	uint64_t		FineWord ( float frequency );
+	void			WritePhaseWord ( uint8_t index );
+	void			WriteFrequencyWord ( uint8_t index, uint32_t freqWord );
+	void			WriteFrequencyWords ( uint8_t index, uint32_t freqWord,
+						uint16_t lsbWord, uint16_t msbWord );
+	void			WriteAllRegisters ( void );
+	static void		WaitMicros ( uint32_t micros );
+
+	/* The layout is kept small for boards with many channels: settings
+	 * are register words and bit fields, and the reference frequency
+	 * and startup delays are shared.
+	 */
+	const AD9833Reference	*reference;
+	AD9833Transport	*transport;		// NULL for the SPI library
 #ifndef FNC_PIN
 	uint8_t			FNCpin;
 #endif
-	uint8_t			outputEnabled, DacDisabled, IntClkDisabled;
-	uint32_t		refFrequency;
-	float			frequency0, frequency1, phase0, phase1;
-	Registers		activeFreq, activePhase;
+	uint8_t			waveForm0, waveForm1;	// WaveformType & WAVEFORM_BITS
+	uint8_t			outputEnabled : 1;
+	uint8_t			DacDisabled : 1;
+	uint8_t			IntClkDisabled : 1;
+	uint8_t			activeFreq : 1;		// REG0 / REG1
+	uint8_t			activePhase : 1;
+	uint8_t			startPending : 1;	// Writes made while starting
+	uint8_t			startState : 2;		// BeginAsync / ResetAsync progress
+	uint8_t			freqMode : 2;		// (B28_CMD, HLB_CMD or 0) >> 12
+	// The register words are the authoritative state. freqFrac holds
+	// the fraction of a word that IncrementFrequency carries, and the
+	// top 12 bits of phaseFine are the phase word.
+	uint32_t		freqWord[2];
+	uint16_t		freqFrac[2];
+	uint32_t		phaseFine[2];
+
+	// Shadow copies of what the AD9833 registers hold. Writes that
+	// would not change a register are not sent. A SHADOW_FREQn bit
+	// means the chip holds freqWord[n].
+	uint16_t		controlShadow, phaseShadow[2];
+	uint8_t			shadowValid;
+
+	uint32_t		startMicros;		// When the current startup wait began
+	static uint32_t	powerUpMicros, resetMicros;
+
+	// Words held between BeginUpdate and CommitUpdate
+	uint16_t		updateBuffer[UPDATE_BUFFER_SIZE];
+	uint8_t			updateCount, updateDepth;
+
+#ifdef AD9833_INSTRUMENT
+	static AD9833Stats	stats;		// One for all devices, to spare RAM
+#endif
 };
 
 #endif
@@ -0,0 +1,171 @@
+/*
+ * AD9833Array.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+#include "AD9833Array.h"
+
+AD9833Array :: AD9833Array ( AD9833 *devices[], uint8_t count ) {
+	this->devices = devices;
+	this->count = count > ARRAY_MAX_DEVICES ? ARRAY_MAX_DEVICES : count;
+	updateDepth = 0;
+}
+
+/*
+ * Start SPI and place every AD9833 in the RESET state, with one power
+ * up delay for all of them
+ */
+void AD9833Array :: Begin ( void ) {
+	for ( uint8_t i = 0; i < count; i++ ) {
+		devices[i]->shadowValid = 0;	// Chips may have been power cycled
+		AD9833_DEBUG_PIN_BEGIN();
+		if ( devices[i]->transport ) devices[i]->transport->Begin();
+	}
+	SPI.begin();
+	AD9833::WaitMicros(AD9833::powerUpMicros);
+	Reset();
+}
+
+/*
+ * Hold the writes of every device until CommitUpdate. Calls may be
+ * nested.
+ */
+void AD9833Array :: BeginUpdate ( void ) {
+	updateDepth++;
+	for ( uint8_t i = 0; i < count; i++ )
+		devices[i]->BeginUpdate();
+}
+
+/*
+ * Send the held writes of every device in one SPI transaction
+ */
+void AD9833Array :: CommitUpdate ( void ) {
+	if ( updateDepth == 0 ) return;
+	updateDepth--;
+	for ( uint8_t i = 0; i < count; i++ ) {
+		if ( devices[i]->updateDepth ) devices[i]->updateDepth--;
+	}
+	if ( updateDepth == 0 ) Flush();
+}
+
+/*
+ * Hold every AD9833 in RESET. See AD9833::Reset.
+ */
+void AD9833Array :: Reset ( void ) {
+	for ( uint8_t i = 0; i < count; i++ ) {
+		AD9833 *device = devices[i];
+		device->updateDepth++;			// Hold the word for Flush
+		device->WriteRegister(RESET_CMD);
+		device->updateDepth--;
+		device->controlShadow = RESET_CMD;
+		device->shadowValid |= SHADOW_CONTROL;
+	}
+	Flush();		// RESET goes out now, even inside BeginUpdate
+	AD9833::WaitMicros(AD9833::resetMicros);
+}
+
+void AD9833Array :: SetWaveform ( Registers waveFormReg, WaveformType waveType ) {
+	BeginUpdate();
+	for ( uint8_t i = 0; i < count; i++ )
+		devices[i]->SetWaveform(waveFormReg,waveType);
+	CommitUpdate();
+}
+
+void AD9833Array :: SetOutputSource ( Registers freqReg, Registers phaseReg ) {
+	BeginUpdate();
+	for ( uint8_t i = 0; i < count; i++ )
+		devices[i]->SetOutputSource(freqReg,phaseReg);
+	CommitUpdate();
+}
+
+void AD9833Array :: EnableOutput ( bool enable ) {
+	BeginUpdate();
+	for ( uint8_t i = 0; i < count; i++ )
+		devices[i]->EnableOutput(enable);
+	CommitUpdate();
+}
+
+void AD9833Array :: SleepMode ( bool enable ) {
+	BeginUpdate();
+	for ( uint8_t i = 0; i < count; i++ )
+		devices[i]->SleepMode(enable);
+	CommitUpdate();
+}
+
+// --------------------- PRIVATE FUNCTIONS --------------------------
+
+/*
+ * Send the words held by every device in one SPI transaction. Devices
+ * holding identical words are selected together and the words are sent
+ * once; the AD9833 only listens to SDATA while its FNC pin is LOW.
+ * Devices with a transport are sent after the transaction is closed,
+ * since their transport may drive the same SPI port.
+ */
+void AD9833Array :: Flush ( void ) {
+	uint32_t done = 0;				// Devices already sent
+	bool started = false;
+
+	for ( uint8_t i = 0; i < count; i++ ) {
+		AD9833 *device = devices[i];
+		if ( (done & (1UL << i)) || device->updateCount == 0 ||
+			 device->transport ) continue;
+
+		if ( !started ) {
+			AD9833_DEBUG_PIN_HIGH();
+			AD9833::BeginTransaction();
+			started = true;
+		}
+
+		// Everyone else holding the same words joins this broadcast
+		uint32_t group = 1UL << i;
+		for ( uint8_t j = i + 1; j < count; j++ ) {
+			AD9833 *other = devices[j];
+			if ( !other->transport &&
+				 other->updateCount == device->updateCount &&
+				 memcmp(other->updateBuffer,device->updateBuffer,
+					device->updateCount * sizeof(uint16_t)) == 0 )
+				group |= 1UL << j;
+		}
+
+		for ( uint8_t j = i; j < count; j++ ) {
+			if ( group & (1UL << j) ) {
+				devices[j]->SelectChip(true);
+				AD9833_STATS_WORDS(devices[j]->stats,device->updateBuffer,
+					device->updateCount);
+			}
+		}
+		AD9833::TransferWords(device->updateBuffer,device->updateCount);
+		for ( uint8_t j = i; j < count; j++ ) {
+			if ( group & (1UL << j) ) {
+				devices[j]->SelectChip(false);
+				devices[j]->updateCount = 0;
+			}
+		}
+		done |= group;
+	}
+
+	if ( started ) {
+		AD9833::EndTransaction();
+		AD9833_DEBUG_PIN_LOW();
+	}
+
+	for ( uint8_t i = 0; i < count; i++ )
+		if ( devices[i]->transport ) devices[i]->FlushUpdate();	// Own FSYNC
+}
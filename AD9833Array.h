@@ -0,0 +1,94 @@
+/*
+ * AD9833Array.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef __AD9833_ARRAY__
+
+#define __AD9833_ARRAY__
+
+#include "AD9833.h"
+
+#ifndef ARRAY_MAX_DEVICES
+#define ARRAY_MAX_DEVICES	32			// Devices one AD9833Array can manage
+#endif
+
+/*
+ * Several AD9833s sharing SCK / MOSI, each with its own FNC pin.
+ *
+ * Between BeginUpdate and CommitUpdate, the AD9833 functions of every
+ * device are held back. CommitUpdate then sends them all in a single
+ * SPI transaction: devices with identical words get them once, with
+ * all their FNC pins LOW together (broadcast), and the rest are sent
+ * back to back.
+ *
+ *		AD9833 gen0(4), gen1(5), gen2(6);
+ *		AD9833 *channels[] = { &gen0, &gen1, &gen2 };
+ *		AD9833Array bus(channels,3);
+ *
+ *		bus.Begin();				// Instead of gen0.Begin() etc.
+ *		bus.BeginUpdate();
+ *		gen0.SetFrequency(REG0,1000);
+ *		gen1.SetFrequency(REG0,2000);
+ *		gen2.SetFrequency(REG0,3000);
+ *		bus.CommitUpdate();
+ *		bus.EnableOutput(true);		// One word for all three
+ *
+ * Not useful with FNC_PIN defined, since every device would then share
+ * one FNC pin.
+ */
+class AD9833Array {
+
+public:
+
+	AD9833Array ( AD9833 *devices[], uint8_t count );
+
+	// Begin every device with a single power up delay. Use instead of
+	// calling Begin for each device.
+	void Begin ( void );
+
+	// Hold the writes of every device until CommitUpdate
+	void BeginUpdate ( void );
+
+	// Send the held writes of every device in one SPI transaction
+	void CommitUpdate ( void );
+
+	// The AD9833 functions, applied to every device. When the devices
+	// share the same settings this is one broadcast word.
+	void Reset ( void );
+	void SetWaveform ( Registers waveFormReg, WaveformType waveType );
+	void SetOutputSource ( Registers freqReg, Registers phaseReg = SAME_AS_REG0 );
+	void EnableOutput ( bool enable );
+	void SleepMode ( bool enable );
+
+	uint8_t GetCount ( void ) { return count; }
+	AD9833 &operator[] ( uint8_t index ) { return *devices[index]; }
+
+private:
+
+	void			Flush ( void );
+
+	AD9833			**devices;
+	uint8_t			count;
+	uint8_t			updateDepth;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * AD9833Async.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+#include "AD9833Async.h"
+
+#define ASYNC_QUEUE_MASK	(ASYNC_QUEUE_FRAMES - 1)
+
+#if (ASYNC_QUEUE_FRAMES & ASYNC_QUEUE_MASK) || ASYNC_QUEUE_FRAMES > 128
+#error "ASYNC_QUEUE_FRAMES must be a power of 2, 128 or less"
+#endif
+
+/*
+ * Keep the engine interrupt out while starting a transfer. The
+ * interrupt state is restored, so Write may be called from an ISR.
+ *
+ * CAN_WAIT is true if the engine interrupt can run while Write waits
+ * for room: interrupts are on and, on ARM, Write is not itself in a
+ * handler (the engine's priority may be no higher). Other boards can
+ * say whether interrupts are on with ASYNC_INTERRUPTS_ON(); if they do
+ * not, they are assumed to be.
+ */
+#if defined(SREG)
+	#define ENTER_CRITICAL()	uint8_t sreg = SREG; noInterrupts()
+	#define EXIT_CRITICAL()		SREG = sreg
+	#define CAN_WAIT()			(SREG & _BV(SREG_I))
+#elif defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+	#define ENTER_CRITICAL()	uint32_t primask = __get_PRIMASK(); __disable_irq()
+	#define EXIT_CRITICAL()		__set_PRIMASK(primask)
+	#define CAN_WAIT()			(__get_PRIMASK() == 0 && (__get_IPSR() & 0x1FF) == 0)
+#else
+	#ifdef ASYNC_INTERRUPTS_ON
+		#define INTERRUPTS_ON()	ASYNC_INTERRUPTS_ON()
+	#else
+		#define INTERRUPTS_ON()	true
+	#endif
+	#define ENTER_CRITICAL()	bool on = INTERRUPTS_ON(); noInterrupts()
+	#define EXIT_CRITICAL()		if ( on ) interrupts()
+	#define CAN_WAIT()			INTERRUPTS_ON()
+#endif
+
+AD9833AsyncSPI :: AD9833AsyncSPI ( uint8_t FNCpin ) {
+	this->FNCpin = FNCpin;
+	callback = NULL;
+	head = tail = 0;
+	active = false;
+	framesSent = 0;
+	framesDropped = 0;
+}
+
+/*
+ * FSYNC HIGH, then let the engine set up the bus
+ */
+void AD9833AsyncSPI :: Begin ( void ) {
+	Flush();						// Finish anything from before
+	pinMode(FNCpin,OUTPUT);
+	digitalWrite(FNCpin,HIGH);
+	framesSent = 0;
+	framesDropped = 0;
+	BeginEngine();
+}
+
+/*
+ * Queue the words as one frame and start the engine if it is idle.
+ * Only waits if the queue is full, and only if the engine can empty it
+ * meanwhile; otherwise the frame is dropped and false returned.
+ */
+bool AD9833AsyncSPI :: Write ( const uint16_t *words, uint8_t count ) {
+	if ( count == 0 ) return true;
+	if ( count > UPDATE_BUFFER_SIZE ) count = UPDATE_BUFFER_SIZE;
+
+	uint8_t next = (head + 1) & ASYNC_QUEUE_MASK;
+	if ( next == tail ) {			// Full
+		if ( !CAN_WAIT() ) {		// Waiting would never end
+			framesDropped++;
+			return false;
+		}
+		while ( next == tail ) ;	// Wait for the engine
+	}
+
+	uint8_t *frame = frames[head];
+	for ( uint8_t i = 0; i < count; i++ ) {
+		frame[2 * i] = highByte(words[i]);
+		frame[2 * i + 1] = lowByte(words[i]);
+	}
+	lengths[head] = 2 * count;
+
+	ENTER_CRITICAL();
+	head = next;					// Publish after the copy
+	if ( !active ) {
+		active = true;
+		StartNext();
+	}
+	EXIT_CRITICAL();
+	return true;
+}
+
+/*
+ * True until the last queued frame has been sent
+ */
+bool AD9833AsyncSPI :: Busy ( void ) {
+	return active;
+}
+
+void AD9833AsyncSPI :: SetCallback ( AD9833AsyncCallback callback ) {
+	this->callback = callback;
+}
+
+uint32_t AD9833AsyncSPI :: GetFramesSent ( void ) {
+	ENTER_CRITICAL();
+	uint32_t sent = framesSent;
+	EXIT_CRITICAL();
+	return sent;
+}
+
+uint32_t AD9833AsyncSPI :: GetFramesDropped ( void ) {
+	ENTER_CRITICAL();
+	uint32_t dropped = framesDropped;
+	EXIT_CRITICAL();
+	return dropped;
+}
+
+/*
+ * End the frame that was being sent and start the next one, or go idle
+ * and tell the callback
+ */
+void AD9833AsyncSPI :: TransferComplete ( void ) {
+	digitalWrite(FNCpin,HIGH);		// The AD9833 latches the last word
+	framesSent++;
+	tail = (tail + 1) & ASYNC_QUEUE_MASK;	// Release the frame
+	if ( tail != head ) {
+		StartNext();
+		return;
+	}
+	active = false;
+	if ( callback ) callback();
+}
+
+// --------------------- PRIVATE FUNCTIONS --------------------------
+
+/*
+ * Frame the oldest queued frame and hand it to the engine
+ */
+void AD9833AsyncSPI :: StartNext ( void ) {
+	uint8_t t = tail;
+	digitalWrite(FNCpin,LOW);
+	StartTransfer(frames[t],lengths[t]);
+}
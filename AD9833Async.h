@@ -0,0 +1,103 @@
+/*
+ * AD9833Async.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef __AD9833_ASYNC__
+
+#define __AD9833_ASYNC__
+
+#include "AD9833.h"
+
+#ifndef ASYNC_QUEUE_FRAMES
+#define ASYNC_QUEUE_FRAMES		4		// Frames. Must be a power of 2.
+#endif
+
+typedef void (*AD9833AsyncCallback) ( void );
+
+/*
+ * Non-blocking transport. Each Write is copied into a queue of frames
+ * and the call returns at once; the frames are clocked out by an engine
+ * (DMA or an SPI interrupt) while the CPU gets on with something else.
+ * FSYNC is driven LOW before each frame and HIGH when its last word is
+ * out, and the callback runs when the queue has drained.
+ *
+ * An engine derives from this class, sends the bytes given to
+ * StartTransfer and calls TransferComplete (normally from its interrupt)
+ * when they are out. AD9833SPIInterrupt.h is an engine for AVR and
+ * AD9833SAMD21DMA.h one for SAMD21; the host build has a simulated DMA
+ * engine.
+ *
+ * Write only waits if the queue is full, which can only drain if the
+ * engine's interrupt can run. With interrupts off, or from an interrupt
+ * on ARM, it drops the frame and returns false instead.
+ */
+class AD9833AsyncSPI : public AD9833Transport {
+
+public:
+
+	AD9833AsyncSPI ( uint8_t FNCpin );
+
+	void Begin ( void );
+	bool Write ( const uint16_t *words, uint8_t count );
+	bool Busy ( void );
+
+	// Called (from interrupt context) each time the queue empties
+	void SetCallback ( AD9833AsyncCallback callback );
+
+	// Frames sent since Begin
+	uint32_t GetFramesSent ( void );
+
+	// Frames Write dropped since Begin because the queue was full and
+	// could not drain
+	uint32_t GetFramesDropped ( void );
+
+	// The engine calls this when the bytes of the last StartTransfer
+	// have all been clocked out
+	void TransferComplete ( void );
+
+protected:
+
+	// Set up the engine and SPI bus
+	virtual void BeginEngine ( void ) = 0;
+
+	// Start clocking out 'count' bytes. 'data' stays valid until
+	// TransferComplete is called.
+	virtual void StartTransfer ( const uint8_t *data, uint8_t count ) = 0;
+
+private:
+
+	void			StartNext ( void );
+
+	uint8_t			FNCpin;
+	AD9833AsyncCallback	callback;
+
+	// Frames as big endian bytes, ready for the engine
+	uint8_t			frames[ASYNC_QUEUE_FRAMES][2 * UPDATE_BUFFER_SIZE];
+	uint8_t			lengths[ASYNC_QUEUE_FRAMES];
+	volatile uint8_t	head;		// Written only by Write
+	volatile uint8_t	tail;		// Written only by TransferComplete
+	volatile bool	active;			// A frame is being sent
+	volatile uint32_t	framesSent;
+	volatile uint32_t	framesDropped;
+};
+
+#endif
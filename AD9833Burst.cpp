@@ -0,0 +1,127 @@
+/*
+ * AD9833Burst.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+
+#include "AD9833Burst.h"
+
+AD9833Burst :: AD9833Burst ( AD9833 &gen ) : gen(gen) {
+	onTicks = offTicks = 1;
+	remaining = 0;
+	edgeError = 0;
+	limit = bursts = 0;
+	on = running = false;
+}
+
+/*
+ * The burst length is worked out from the frequency the chip will
+ * actually make (the programmed word), not the one asked for
+ */
+void AD9833Burst :: Setup ( WaveformType waveType, float frequencyHz,
+		uint16_t cycles, uint32_t intervalMicros, uint32_t timerClockHz ) {
+	Stop();
+	gen.BeginUpdate();
+	gen.SetFrequency(REG0,frequencyHz);
+	gen.SetPhase(REG0,0.0);					// Start and end at phase 0
+	gen.SetWaveform(REG0,waveType);
+	gen.CommitUpdate();
+
+	float actual = gen.GetActualProgrammedFrequency(REG0);
+	float burst = actual > 0 ? cycles / actual : 0;		// Seconds
+	onTicks = (uint32_t)(burst * timerClockHz + 0.5);
+	if ( onTicks == 0 ) onTicks = 1;
+	edgeError = (float)onTicks / timerClockHz - burst;
+
+	uint32_t interval = (uint32_t)(intervalMicros * (timerClockHz / 1e6) + 0.5);
+	offTicks = interval > onTicks ? interval - onTicks : 1;
+}
+
+/*
+ * Precompute the two control words: PHASE0 and REG0 with the current
+ * waveform, DAC and clock settings, with and without RESET
+ */
+void AD9833Burst :: Start ( uint16_t bursts ) {
+	running = false;
+	controlWord[1] = gen.GetControlWord(REG0,REG0) & ~RESET_CMD;
+	controlWord[0] = controlWord[1] | RESET_CMD;
+	gen.WriteControlWord(controlWord[0]);
+	on = false;
+	remaining = 0;							// On at the next Tick
+	limit = bursts;
+	this->bursts = 0;
+	running = true;
+}
+
+void AD9833Burst :: Stop ( void ) {
+	if ( !running ) return;
+	running = false;
+	gen.WriteControlWord(controlWord[0]);
+	on = false;
+}
+
+bool AD9833Burst :: IsRunning ( void ) {
+	return running;
+}
+
+uint16_t AD9833Burst :: GetBursts ( void ) {
+	return bursts;
+}
+
+uint32_t AD9833Burst :: GetOnTicks ( void ) {
+	return onTicks;
+}
+
+uint32_t AD9833Burst :: GetOffTicks ( void ) {
+	return offTicks;
+}
+
+float AD9833Burst :: GetEdgeError ( void ) {
+	return edgeError;
+}
+
+/*
+ * At an edge, write its control word first (the timer is already
+ * counting the next period), then hand back the time to the next one.
+ * A time longer than BURST_MAX_TICKS is split so the last part is at
+ * least half of it, never a few clocks the interrupt could overrun.
+ */
+uint32_t AD9833Burst :: Tick ( void ) {
+	if ( !running ) return 0;
+	if ( remaining == 0 ) {
+		on = !on;
+		gen.WriteControlWord(controlWord[on]);
+		if ( on )
+			remaining = onTicks;
+		else {
+			bursts++;
+			if ( limit && bursts >= limit ) {
+				running = false;
+				return 0;
+			}
+			remaining = offTicks;
+		}
+	}
+	uint32_t wait = remaining;
+	if ( wait > BURST_MAX_TICKS )
+		wait = wait >= 2 * BURST_MAX_TICKS ? BURST_MAX_TICKS : wait / 2;
+	remaining -= wait;
+	return wait;
+}
@@ -0,0 +1,120 @@
+/*
+ * AD9833Burst.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef __AD9833_BURST__
+
+#define __AD9833_BURST__
+
+#include "AD9833.h"
+
+#ifndef BURST_TIMER_CLOCK
+#ifdef F_CPU
+#define BURST_TIMER_CLOCK	F_CPU		// AD9833Timer1 with no prescaler
+#else
+#define BURST_TIMER_CLOCK	16000000UL
+#endif
+#endif
+
+#ifndef BURST_MAX_TICKS
+#define BURST_MAX_TICKS		65536UL		// Longest timer period (16 bits)
+#endif
+
+/*
+ * Tone bursts: 'cycles' cycles of a frequency, repeated at a fixed
+ * interval, gated with the RESET bit. The on and off control words are
+ * worked out once, so each edge is a single control word write from
+ * Tick, called from a timer interrupt; loop() does nothing per burst.
+ *
+ * Releasing RESET starts the phase accumulator from 0, so every burst
+ * starts at the same point of the waveform. The on time is the nearest
+ * whole number of timer clocks to 'cycles' periods of the programmed
+ * frequency, so the burst ends within half a timer clock of a cycle
+ * boundary. Both edges go through the same code, so the time from
+ * the timer match to the chip varies only with interrupt latency.
+ *
+ * Tick returns the timer clocks until the next Tick, to be loaded as
+ * the next timer period (AD9833Timer1::SetPeriodTicks). Long times
+ * are split into periods of at most BURST_MAX_TICKS. Each must be
+ * longer than the interrupt and the control word write.
+ *
+ *	void BurstTick ( void ) {
+ *		uint32_t wait = burst.Tick();
+ *		if ( wait ) AD9833Timer1::SetPeriodTicks(wait);
+ *		else AD9833Timer1::Stop();
+ *	}
+ *
+ * While running, Tick writes to the AD9833 from interrupt context, so
+ * leave the other AD9833 functions alone until Stop has been called.
+ */
+class AD9833Burst {
+
+public:
+
+	AD9833Burst ( AD9833 &gen );
+
+	// Load REG0 with frequencyHz at phase 0. Each burst is 'cycles'
+	// cycles long and one starts every intervalMicros, timed with a
+	// timer clocked at timerClockHz.
+	void Setup ( WaveformType waveType, float frequencyHz, uint16_t cycles,
+		uint32_t intervalMicros, uint32_t timerClockHz = BURST_TIMER_CLOCK );
+
+	// Hold the output in RESET and start the first burst at the next
+	// Tick. Stop after 'bursts' bursts, or never with 0. Call after any
+	// change to the sleep or DAC settings.
+	void Start ( uint16_t bursts = 0 );
+
+	// Stop at once, with the output held in RESET
+	void Stop ( void );
+
+	// True from Start until the last burst has ended or Stop
+	bool IsRunning ( void );
+
+	// Bursts finished since Start
+	uint16_t GetBursts ( void );
+
+	// Timer clocks of each burst, and of the time between bursts
+	uint32_t GetOnTicks ( void );
+	uint32_t GetOffTicks ( void );
+
+	// Length of the burst less 'cycles' periods of the programmed
+	// frequency, in seconds (at most half a timer clock)
+	float GetEdgeError ( void );
+
+	// Write the next edge if it is due. Returns the timer clocks to the
+	// next Tick, or 0 once the last burst has ended.
+	uint32_t Tick ( void );
+
+private:
+
+	AD9833			&gen;
+	uint16_t		controlWord[2];		// Off (RESET), on
+	uint32_t		onTicks, offTicks;
+	uint32_t		remaining;			// Clocks to the next edge
+	float			edgeError;
+	uint16_t		limit;
+	volatile uint16_t	bursts;
+	bool			on;
+	volatile bool	running;
+};
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * AD9833Dither.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+
+#include "AD9833Dither.h"
+
+AD9833Dither :: AD9833Dither ( AD9833 &gen ) : gen(gen) {
+	fraction = 0;
+	accumulator = 0;
+	freqWord = 0;
+	running = false;
+}
+
+/*
+ * Split the target into a word and a fraction with integer math: a
+ * float has 24 bits, which is not enough for a 28 bit word plus 16
+ * bits of fraction. (frequencyHz * 1000 + milliHz) * 2^28 is below
+ * 2^62 for frequencies up to 12.5 MHz.
+ */
+void AD9833Dither :: Setup ( WaveformType waveType, uint32_t frequencyHz,
+		uint16_t milliHz ) {
+	if ( frequencyHz >= 12500000UL ) {
+		frequencyHz = 12500000UL;
+		milliHz = 0;
+	}
+	uint64_t target = ((uint64_t)frequencyHz * 1000 + milliHz) << 28;
+	uint64_t step = (uint64_t)gen.GetReferenceFrequency() * 1000;
+	uint32_t word = (uint32_t)(target / step);
+	uint16_t fine = (uint16_t)(((target % step) << DITHER_FRACTION_BITS) / step);
+	SetupWord(waveType,word,fine);
+}
+
+/*
+ * Preload REG0 with freqWord and REG1 with freqWord + 1, both with the
+ * waveform. A word at the top of the range can not be dithered up.
+ */
+void AD9833Dither :: SetupWord ( WaveformType waveType, uint32_t freqWord,
+		uint16_t fraction ) {
+	Stop();
+	freqWord &= FREQ_WORD_MASK;
+	if ( freqWord == FREQ_WORD_MASK ) fraction = 0;
+	this->freqWord = freqWord;
+	this->fraction = fraction;
+	gen.BeginUpdate();
+	gen.SetFrequencyWord(REG0,freqWord);
+	gen.SetFrequencyWord(REG1,freqWord + (freqWord < FREQ_WORD_MASK));
+	gen.SetWaveform(REG0,waveType);
+	gen.SetWaveform(REG1,waveType);
+	gen.CommitUpdate();
+}
+
+/*
+ * The new fraction takes effect from the next Tick. The sigma delta
+ * state is kept, so there is no step in the phase.
+ */
+void AD9833Dither :: SetFraction ( uint16_t fraction ) {
+	if ( freqWord == FREQ_WORD_MASK ) fraction = 0;
+	noInterrupts();						// 16 bits: two stores on AVR
+	this->fraction = fraction;
+	interrupts();
+}
+
+/*
+ * Precompute the two control words, both on PHASE0, and start on the
+ * lower word
+ */
+void AD9833Dither :: Start ( void ) {
+	running = false;
+	controlWord[0] = gen.GetControlWord(REG0,REG0);
+	controlWord[1] = gen.GetControlWord(REG1,REG0);
+	accumulator = 0;
+	gen.WriteControlWord(controlWord[0]);
+	running = true;
+}
+
+void AD9833Dither :: Stop ( void ) {
+	if ( !running ) return;
+	running = false;
+	gen.WriteControlWord(controlWord[0]);
+}
+
+uint32_t AD9833Dither :: GetWord ( void ) {
+	return freqWord;
+}
+
+uint16_t AD9833Dither :: GetFraction ( void ) {
+	return fraction;
+}
+
+float AD9833Dither :: GetFrequencyOffset ( void ) {
+	return gen.GetResolution() * fraction / (1UL << DITHER_FRACTION_BITS);
+}
+
+/*
+ * After N ticks the sigma delta has used the upper word
+ * floor(N * fraction) times (plus the carry it started with), so the
+ * average is within one word / N of the target.
+ */
+float AD9833Dither :: GetEffectiveResolution ( float tickRateHz,
+		float averagingSeconds ) {
+	float ticks = tickRateHz * averagingSeconds;
+	if ( ticks < 1 ) ticks = 1;
+	if ( ticks > (1UL << DITHER_FRACTION_BITS) )
+		ticks = 1UL << DITHER_FRACTION_BITS;
+	return gen.GetResolution() / ticks;
+}
+
+/*
+ * Against the target, the phase drifts by accumulator / 65536 of one
+ * word per tick period and is pulled back each time the upper word is
+ * used: at worst a sawtooth of 2 pi resolution / tickRate radians peak
+ * to peak, whose fundamental is 2 resolution / tickRate radians. As
+ * small index phase modulation that is a sideband each side of the
+ * carrier at 20 log10(resolution / tickRate) dBc, at the rate the
+ * rarer of the two words comes round.
+ */
+float AD9833Dither :: GetSpurLevel ( float tickRateHz ) {
+	if ( fraction == 0 ) return -INFINITY;
+	return 20.0 * log10(gen.GetResolution() / tickRateHz);
+}
+
+float AD9833Dither :: GetSpurOffset ( float tickRateHz ) {
+	uint16_t f = fraction;
+	if ( f > 0x8000 ) f = -f;				// The rarer of the two words
+	return tickRateHz * f / (1UL << DITHER_FRACTION_BITS);
+}
+
+/*
+ * One sigma delta step: the carry out of the 16 bit accumulator picks
+ * the upper word for the coming period. WriteControlWord sends nothing
+ * when the register stays the same.
+ */
+void AD9833Dither :: Tick ( void ) {
+	if ( !running ) return;
+	uint16_t before = accumulator;
+	accumulator += fraction;
+	gen.WriteControlWord(controlWord[accumulator < before]);
+}
@@ -0,0 +1,108 @@
+/*
+ * AD9833Dither.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef __AD9833_DITHER__
+
+#define __AD9833_DITHER__
+
+#include "AD9833.h"
+
+#define DITHER_FRACTION_BITS	16		// Target resolution: 1/65536 word
+
+/*
+ * Frequencies between two frequency words. REG0 is loaded with the word
+ * just below the target and REG1 with the next one up; Tick, called
+ * from a timer interrupt, then switches FSEL with a first order sigma
+ * delta pattern so that the average frequency is the target, to
+ * 1/65536 of GetResolution() (about 1.4 uHz at 25 MHz).
+ *
+ * FSEL only chooses the word added to the phase accumulator, so the
+ * output is phase continuous; both registers use PHASE0. Each switch
+ * is one control word.
+ *
+ * The price is a phase error that rises and falls by up to one word
+ * times the tick period: sidebands around the carrier, lower the
+ * faster Tick runs. GetSpurLevel / GetSpurOffset give them for a tick
+ * rate, and GetEffectiveResolution the resolution of the average over
+ * a measuring time.
+ *
+ * While running, Tick writes to the AD9833 from interrupt context, so
+ * leave the other AD9833 functions alone until Stop has been called.
+ */
+class AD9833Dither {
+
+public:
+
+	AD9833Dither ( AD9833 &gen );
+
+	// Load the words either side of frequencyHz + milliHz / 1000
+	void Setup ( WaveformType waveType, uint32_t frequencyHz,
+		uint16_t milliHz = 0 );
+
+	// Load freqWord and freqWord + 1, for an average of
+	// freqWord + fraction / 65536
+	void SetupWord ( WaveformType waveType, uint32_t freqWord, uint16_t fraction );
+
+	// Change the fraction, keeping the two words. Safe while running.
+	void SetFraction ( uint16_t fraction );
+
+	// Begin switching on Tick. Call after any change to the output
+	// enable, sleep or DAC settings.
+	void Start ( void );
+
+	// Stop switching. The output is left on the lower word.
+	void Stop ( void );
+
+	// Lower word and the fraction of a word above it
+	uint32_t GetWord ( void );
+	uint16_t GetFraction ( void );
+
+	// Hz above the lower word's frequency (fraction * GetResolution())
+	float GetFrequencyOffset ( void );
+
+	// Resolution in Hz of the average frequency over averagingSeconds,
+	// ticking at tickRateHz: one word over the number of ticks, but no
+	// finer than 1/65536 word
+	float GetEffectiveResolution ( float tickRateHz, float averagingSeconds );
+
+	// Level of the strongest sideband in dBc (at most; negative) at
+	// tickRateHz, and its distance from the carrier in Hz. With a
+	// fraction of 0 there are none: -INFINITY dBc at 0 Hz.
+	float GetSpurLevel ( float tickRateHz );
+	float GetSpurOffset ( float tickRateHz );
+
+	// Choose the register for the next tick period. Call from a timer
+	// interrupt at a constant rate.
+	void Tick ( void );
+
+private:
+
+	AD9833			&gen;
+	uint16_t		controlWord[2];
+	volatile uint16_t	fraction;
+	uint16_t		accumulator;
+	uint32_t		freqWord;
+	volatile bool	running;
+};
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * AD9833Encoder.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+#include "AD9833Encoder.h"
+#include "AD9833Fast.h"				// AD9833Recip, AD9833RecipShift, AD9833Scaled
+#include <string.h>
+
+#define MAX_FREQUENCY		12.5e6f			// As SetFrequency
+#define DEG_PER_BIT			(360.0f / 4096)	// Exact in a float
+#define HZ_PER_SCALED		(1.0f / (1UL << 28))
+
+/* The words come from AD9833FineWord, as in SetFrequency. The error
+ * comes from the same integers. With frequency * 2^28 = scaled + below
+ * (below only for frequencies under 1/32 Hz) and
+ * scaled = word * refFrequency + remainder:
+ *	frequency	error = -(remainder + below) / 2^28. remainder converts
+ *				with one rounding, and scaled / 2^28 is exact, so the
+ *				bits do not depend on whether the compiler fuses
+ *				multiply and add.
+ *	phase		word * 360 / 4096 is exact (12 bits times 45 / 512)
+ */
+
+AD9833Encoder :: AD9833Encoder ( uint32_t referenceFrequency ) {
+	if ( referenceFrequency == 0 ) referenceFrequency = AD9833_DEFAULT_REFERENCE;
+	refFrequency = referenceFrequency;
+	freqRecip = AD9833Recip(referenceFrequency);
+	freqRecipShift = AD9833RecipShift(referenceFrequency);
+}
+
+void AD9833Encoder :: EncodeFrequenciesScalar ( const float *frequencies,
+		size_t count, Registers freqReg, uint16_t *words, float *errors ) {
+	uint16_t reg = freqReg == REG0 ? FREQ0_WRITE_REG : FREQ1_WRITE_REG;
+	for ( size_t i = 0; i < count; i++ ) {
+		float frequency = frequencies[i];
+		if ( frequency > MAX_FREQUENCY ) frequency = MAX_FREQUENCY;
+		if ( !(frequency >= 0.0f) ) frequency = 0.0f;		// Also NaN
+		uint64_t word = AD9833FineWord(frequency,refFrequency,freqRecip,
+			freqRecipShift) >> FREQ_FINE_BITS;
+		uint32_t bits;
+		memcpy(&bits,&frequency,sizeof(bits));
+		uint64_t scaled = bits < 0x00800000UL ? 0 :	// Below 2^-126 Hz the word is 0
+			AD9833Scaled((bits & 0x7FFFFF) | 0x800000,(int16_t)(bits >> 23) - 122);
+		uint64_t remainder = scaled - word * refFrequency;
+		float error = -((float)remainder * HZ_PER_SCALED +
+			(frequency - (float)scaled * HZ_PER_SCALED));
+		word &= FREQ_WORD_MASK;
+		words[2 * i] = (word & 0x3FFF) | reg;
+		words[2 * i + 1] = (word >> 14) | reg;
+		if ( errors ) errors[i] = error;
+	}
+}
+
+void AD9833Encoder :: EncodePhasesScalar ( const float *phases, size_t count,
+		Registers phaseReg, uint16_t *words, float *errors ) {
+	uint16_t reg = phaseReg == REG0 ? PHASE_WRITE_CMD : PHASE_WRITE_CMD | PHASE1_WRITE_REG;
+	for ( size_t i = 0; i < count; i++ ) {
+		float phaseInDeg = fmod(phases[i],360);		// As SetPhase
+		if ( phaseInDeg < 0 ) phaseInDeg += 360;
+		if ( phaseInDeg >= 360 ) phaseInDeg -= 360;	// Tiny negative phases
+		uint16_t word = (uint32_t)(BITS_PER_DEG * phaseInDeg *
+			(1UL << PHASE_FINE_BITS)) >> PHASE_FINE_BITS;
+		words[i] = word | reg;
+		if ( errors ) errors[i] = (float)word * DEG_PER_BIT - phaseInDeg;
+	}
+}
+
+/*
+ * Frequencies are done one at a time everywhere: in vector form the
+ * 64 bit multiply and the exact correction cost more than the scalar
+ * loop (60 against 32 cycles a value on an x86-64 PC).
+ */
+void AD9833Encoder :: EncodeFrequencies ( const float *frequencies, size_t count,
+		Registers freqReg, uint16_t *words, float *errors ) {
+	EncodeFrequenciesScalar(frequencies,count,freqReg,words,errors);
+}
+
+#if AD9833_ENCODER_LANES > 1
+
+#define LANES		AD9833_ENCODER_LANES
+
+typedef float		EncFloat __attribute__((vector_size(LANES * 4)));
+typedef double		EncDouble __attribute__((vector_size(LANES * 8)));
+typedef uint32_t	EncWord __attribute__((vector_size(LANES * 4)));
+typedef int32_t		EncInt __attribute__((vector_size(LANES * 4)));
+
+/*
+ * Blocks with every phase in [0, 360), where fmod changes nothing, are
+ * done LANES at a time; the others go through the scalar loop.
+ */
+void AD9833Encoder :: EncodePhases ( const float *phases, size_t count,
+		Registers phaseReg, uint16_t *words, float *errors ) {
+	uint16_t reg = phaseReg == REG0 ? PHASE_WRITE_CMD : PHASE_WRITE_CMD | PHASE1_WRITE_REG;
+	const EncFloat zero = { }, turn = zero + 360.0f;
+	size_t i = 0;
+	for ( ; i + LANES <= count; i += LANES ) {
+		EncFloat phase;
+		memcpy(&phase,phases + i,sizeof(phase));
+		EncInt inRange = (phase >= zero) & (phase < turn);
+		bool all = true;
+		for ( uint8_t l = 0; l < LANES; l++ ) all &= inRange[l] != 0;
+		if ( !all ) {
+			EncodePhasesScalar(phases + i,LANES,phaseReg,words + i,
+				errors ? errors + i : NULL);
+			continue;
+		}
+		EncWord word = __builtin_convertvector(BITS_PER_DEG *
+			__builtin_convertvector(phase,EncDouble) * (double)(1UL << PHASE_FINE_BITS),
+			EncWord) >> PHASE_FINE_BITS;
+		EncWord write = word | reg;
+		for ( uint8_t l = 0; l < LANES; l++ ) words[i + l] = write[l];
+		if ( errors ) {
+			EncFloat result = __builtin_convertvector(word,EncFloat) * DEG_PER_BIT - phase;
+			memcpy(errors + i,&result,sizeof(result));
+		}
+	}
+	EncodePhasesScalar(phases + i,count - i,phaseReg,words + i,
+		errors ? errors + i : NULL);
+}
+
+#else
+
+void AD9833Encoder :: EncodePhases ( const float *phases, size_t count,
+		Registers phaseReg, uint16_t *words, float *errors ) {
+	EncodePhasesScalar(phases,count,phaseReg,words,errors);
+}
+
+#endif
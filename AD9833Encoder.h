@@ -0,0 +1,86 @@
+/*
+ * AD9833Encoder.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * Bulk encoding of frequency and phase tables into register writes,
+ * for frequency plans and hop lists made offline. Each value goes
+ * through the same math as AD9833::SetFrequency / SetPhase, so the
+ * words are the ones those would send:
+ *
+ *	AD9833Encoder encoder(25000000UL);
+ *	encoder.EncodeFrequencies(hz,count,REG0,words,errors);
+ *	for ( i = 0; i < count; i++ )
+ *		gen.SetFrequencyWords(words[2 * i],words[2 * i + 1]);
+ *
+ * Frequencies go through AD9833FineWord one at a time. On PCs (gcc or
+ * clang with SSE2 or NEON) phases are encoded AD9833_ENCODER_LANES at a
+ * time with vector instructions; on microcontrollers it is a plain
+ * loop. The two produce the same words and errors bit for bit: the
+ * scalar loop is also compiled on the PC, as EncodePhasesScalar, to
+ * check that.
+ */
+
+#ifndef __AD9833_ENCODER__
+
+#define __AD9833_ENCODER__
+
+#include "AD9833.h"
+
+#if !defined(__AVR__) && defined(__GNUC__) && (defined(__SSE2__) || defined(__ARM_NEON))
+#define AD9833_ENCODER_LANES	8
+#else
+#define AD9833_ENCODER_LANES	1
+#endif
+
+class AD9833Encoder {
+
+public:
+
+	AD9833Encoder ( uint32_t referenceFrequency = 25000000UL );
+
+	// Encode count frequencies (Hz) for freqReg. 'words' gets two per
+	// value, the LSB then the MSB write with the FREQ0 / FREQ1 prefix.
+	// 'errors' (may be NULL) gets the output minus the requested
+	// frequency in Hz, after the same limits as SetFrequency.
+	void EncodeFrequencies ( const float *frequencies, size_t count,
+		Registers freqReg, uint16_t *words, float *errors = NULL );
+
+	// Encode count phases (degrees) for phaseReg: one PHASE0 / PHASE1
+	// write each. 'errors' gets the phase minus the requested phase,
+	// taken modulo 360, in degrees.
+	void EncodePhases ( const float *phases, size_t count,
+		Registers phaseReg, uint16_t *words, float *errors = NULL );
+
+	// One value at a time. The same results as the functions above,
+	// which use these on microcontrollers, for the leftover phases and
+	// for every frequency.
+	void EncodeFrequenciesScalar ( const float *frequencies, size_t count,
+		Registers freqReg, uint16_t *words, float *errors = NULL );
+	void EncodePhasesScalar ( const float *phases, size_t count,
+		Registers phaseReg, uint16_t *words, float *errors = NULL );
+
+private:
+
+	uint32_t		refFrequency;
+	uint32_t		freqRecip;		// As in AD9833
+	uint8_t			freqRecipShift;
+};
+
+#endif
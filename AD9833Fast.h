@@ -0,0 +1,265 @@
+/*
+ * AD9833Fast.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * Compile time AD9833 driver. The FNC pin and reference frequency are
+ * template parameters, so:
+ *	- on AVR the FNC pin is written directly through its port register
+ *	  (digitalWriteFast2), for every instance, with no FNC_PIN define
+ *	- frequencies and phases that are constants are turned into
+ *	  register words by the compiler (constexpr), so
+ *		AD9833Fast<4> gen;
+ *		gen.ApplySignal(SINE_WAVE,REG0,1000);
+ *	  compiles to four SPI word writes and nothing else.
+ *
+ * It keeps only the control word as state, so it has no shadow cache,
+ * no Increment functions and no float read back functions; use the
+ * AD9833 class for those.
+ */
+
+#ifndef __AD9833_FAST__
+
+#define __AD9833_FAST__
+
+#include "AD9833.h"
+#include "digitalWriteFast.h"
+
+#define AD9833_ALWAYS_INLINE	inline __attribute__((always_inline))
+
+// ---------------------- Compile time encoding ----------------------
+/*
+ * These match AD9833::FrequencyToWord and AD9833::SetPhase bit for bit.
+ * With constant arguments they are evaluated by the compiler.
+ */
+
+// Shift that gives the reciprocal of refHz the most bits in 32
+constexpr uint8_t AD9833RecipShift ( uint32_t refHz, uint8_t shift = 0 ) {
+	return (shift < 32 && ((1ULL << (29 + shift)) / refHz) <= 0xFFFFFFFFULL) ?
+		AD9833RecipShift(refHz,shift + 1) : shift;
+}
+
+// 2^(28 + shift) / refHz
+constexpr uint32_t AD9833Recip ( uint32_t refHz ) {
+	return (uint32_t)((1ULL << (28 + AD9833RecipShift(refHz))) / refHz);
+}
+
+// frequencyHz (0 to 2^24) = AD9833Mantissa * 2^AD9833Exponent, with the
+// mantissa 2^23 to 2^24 - 1. Doubling a float is exact.
+constexpr int16_t AD9833Exponent ( float frequencyHz, int16_t exponent = 0 ) {
+	return frequencyHz < 8388608.0f ?
+		AD9833Exponent(frequencyHz * 2.0f,exponent - 1) : exponent;
+}
+
+constexpr uint32_t AD9833Mantissa ( float frequencyHz ) {
+	return frequencyHz < 8388608.0f ?
+		AD9833Mantissa(frequencyHz * 2.0f) : (uint32_t)frequencyHz;
+}
+
+// floor(mantissa * 2^scale)
+constexpr uint64_t AD9833Scaled ( uint32_t mantissa, int16_t scale ) {
+	return scale >= 0 ? (uint64_t)mantissa << scale :
+		scale > -24 ? mantissa >> -scale : 0;
+}
+
+// 28 bit frequency word for frequencyHz: floor(frequencyHz * 2^28 / refHz),
+// with the same limits as SetFrequency. With a constant frequency the
+// division is done by the compiler; AD9833Fast uses AD9833FineWord for
+// the others.
+constexpr uint32_t AD9833FrequencyWord ( float frequencyHz, uint32_t refHz ) {
+	return !(frequencyHz >= 1.17549435e-38f) ? 0 :	// Also NaN, as AD9833FineWord
+		frequencyHz > 12.5e6f ? AD9833FrequencyWord(12.5e6f,refHz) :
+		(uint32_t)(AD9833Scaled(AD9833Mantissa(frequencyHz),
+			28 + AD9833Exponent(frequencyHz)) / (refHz ? refHz :
+			AD9833_DEFAULT_REFERENCE)) & FREQ_WORD_MASK;
+}
+
+// FREQ0 / FREQ1 write of the lower and upper 14 bits of a frequency word
+constexpr uint16_t AD9833FreqLSB ( uint32_t freqWord, Registers freqReg ) {
+	return (uint16_t)(freqWord & 0x3FFF) |
+		(freqReg == REG0 ? FREQ0_WRITE_REG : FREQ1_WRITE_REG);
+}
+
+constexpr uint16_t AD9833FreqMSB ( uint32_t freqWord, Registers freqReg ) {
+	return (uint16_t)((freqWord >> 14) & 0x3FFF) |
+		(freqReg == REG0 ? FREQ0_WRITE_REG : FREQ1_WRITE_REG);
+}
+
+// 12 bit phase word for phaseInDeg, which must be 0 to 360 degrees
+constexpr uint16_t AD9833PhaseWord ( float phaseInDeg ) {
+	return (uint16_t)(BITS_PER_DEG * phaseInDeg) & 0x0FFF;
+}
+
+// PHASE0 / PHASE1 write of a phase word
+constexpr uint16_t AD9833PhaseWrite ( uint16_t phaseWord, Registers phaseReg ) {
+	return phaseWord | PHASE_WRITE_CMD | (phaseReg == REG0 ? 0 : PHASE1_WRITE_REG);
+}
+
+// ------------------------ Templated driver -------------------------
+
+template <uint8_t FNCpin, uint32_t RefHz = 25000000UL>
+class AD9833Fast {
+
+public:
+
+	AD9833Fast ( void ) {
+		waveForm[0] = waveForm[1] = SINE_WAVE;
+		control = SINE_WAVE;
+		outputEnabled = false;
+	}
+
+	// Must be the first command. Start SPI and hold the AD9833 in RESET.
+	void Begin ( void ) {
+		pinModeFast2(FNCpin,OUTPUT);
+		digitalWriteFast2(FNCpin,HIGH);
+		SPI.begin();
+		delay(AD9833_POWERUP_MICROS / 1000);
+		Reset();
+	}
+
+	// Restart the phase accumulators and hold RESET until the next
+	// control word (with the output enabled) is written
+	void Reset ( void ) {
+		Write(control | RESET_CMD);
+		delay(AD9833_RESET_MICROS / 1000);
+	}
+
+	// Frequency, phase, waveform and output select in one SPI frame
+	AD9833_ALWAYS_INLINE void ApplySignal ( WaveformType waveType,
+			Registers freqReg, float frequencyInHz,
+			Registers phaseReg = SAME_AS_REG0, float phaseInDeg = 0.0 ) {
+		if ( phaseReg == SAME_AS_REG0 ) phaseReg = freqReg;
+		uint32_t freqWord = Word(frequencyInHz);
+		waveForm[freqReg == REG0 ? 0 : 1] = waveType;
+		SetControl(freqReg,phaseReg);
+		Write(AD9833FreqLSB(freqWord,freqReg),AD9833FreqMSB(freqWord,freqReg),
+			AD9833PhaseWrite(AD9833PhaseWord(phaseInDeg),phaseReg),
+			ControlWord());
+	}
+
+	AD9833_ALWAYS_INLINE void SetFrequency ( Registers freqReg, float frequency ) {
+		SetFrequencyWord(freqReg,Word(frequency));
+	}
+
+	AD9833_ALWAYS_INLINE void SetFrequencyWord ( Registers freqReg, uint32_t freqWord ) {
+		// B28 is always set in the control word, so the two halves can
+		// go out without a control word first
+		Write(AD9833FreqLSB(freqWord,freqReg),AD9833FreqMSB(freqWord,freqReg));
+	}
+
+	AD9833_ALWAYS_INLINE void SetPhase ( Registers phaseReg, float phaseInDeg ) {
+		Write(AD9833PhaseWrite(AD9833PhaseWord(phaseInDeg),phaseReg));
+	}
+
+	AD9833_ALWAYS_INLINE void SetWaveform ( Registers waveFormReg, WaveformType waveType ) {
+		waveForm[waveFormReg == REG0 ? 0 : 1] = waveType;
+		SetControl(control & FREQ1_OUTPUT_REG ? REG1 : REG0,
+			control & PHASE1_OUTPUT_REG ? REG1 : REG0);
+		Write(ControlWord());
+	}
+
+	AD9833_ALWAYS_INLINE void SetOutputSource ( Registers freqReg,
+			Registers phaseReg = SAME_AS_REG0 ) {
+		SetControl(freqReg,phaseReg == SAME_AS_REG0 ? freqReg : phaseReg);
+		Write(ControlWord());
+	}
+
+	AD9833_ALWAYS_INLINE void EnableOutput ( bool enable ) {
+		outputEnabled = enable;
+		Write(ControlWord());
+	}
+
+	// Register words for constant values, e.g. for tables in PROGMEM
+	static constexpr uint32_t FrequencyWord ( float frequencyHz ) {
+		return AD9833FrequencyWord(frequencyHz,RefHz);
+	}
+
+	static constexpr float GetResolution ( void ) {
+		return (float)RefHz / (float)pow2_28;
+	}
+
+	// Raw word writes, all framed by one FNC LOW
+	AD9833_ALWAYS_INLINE void Write ( uint16_t w0 ) {
+		Select();
+		SPI.transfer16(w0);
+		Deselect();
+	}
+
+	AD9833_ALWAYS_INLINE void Write ( uint16_t w0, uint16_t w1 ) {
+		Select();
+		SPI.transfer16(w0);
+		SPI.transfer16(w1);
+		Deselect();
+	}
+
+	AD9833_ALWAYS_INLINE void Write ( uint16_t w0, uint16_t w1, uint16_t w2,
+			uint16_t w3 ) {
+		Select();
+		SPI.transfer16(w0);
+		SPI.transfer16(w1);
+		SPI.transfer16(w2);
+		SPI.transfer16(w3);
+		Deselect();
+	}
+
+private:
+
+	AD9833_ALWAYS_INLINE void SetControl ( Registers freqReg, Registers phaseReg ) {
+		control = waveForm[freqReg == REG0 ? 0 : 1] |
+			(freqReg == REG0 ? 0 : FREQ1_OUTPUT_REG) |
+			(phaseReg == REG0 ? 0 : PHASE1_OUTPUT_REG);
+	}
+
+	AD9833_ALWAYS_INLINE uint16_t ControlWord ( void ) {
+		return outputEnabled ? control : control | RESET_CMD;
+	}
+
+	AD9833_ALWAYS_INLINE void Select ( void ) {
+#ifdef SPI_HAS_TRANSACTION
+		SPI.beginTransaction(SPISettings(AD9833_SPI_CLOCK,MSBFIRST,SPI_MODE2));
+#else
+		SPI.setDataMode(SPI_MODE2);
+#endif
+		digitalWriteFast2(FNCpin,LOW);
+	}
+
+	AD9833_ALWAYS_INLINE void Deselect ( void ) {
+		digitalWriteFast2(FNCpin,HIGH);
+#ifdef SPI_HAS_TRANSACTION
+		SPI.endTransaction();
+#endif
+	}
+
+	// FrequencyWord for a constant, AD9833FineWord (no division) otherwise
+	static AD9833_ALWAYS_INLINE uint32_t Word ( float frequencyHz ) {
+		return __builtin_constant_p(frequencyHz) ? FrequencyWord(frequencyHz) :
+			(uint32_t)(AD9833FineWord(frequencyHz,RefHz,recip,recipShift) >>
+				FREQ_FINE_BITS) & FREQ_WORD_MASK;
+	}
+
+	// Reciprocal of RefHz, worked out by the compiler
+	static constexpr uint32_t	recip = AD9833Recip(RefHz);
+	static constexpr uint8_t	recipShift = AD9833RecipShift(RefHz);
+
+	uint16_t		waveForm[2];
+	uint16_t		control;		// Without the RESET bit
+	bool			outputEnabled;
+};
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * AD9833FreqMeter.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+
+#include "AD9833FreqMeter.h"
+
+AD9833FreqMeter :: AD9833FreqMeter ( uint32_t timerClockHz ) {
+	timerClock = timerClockHz;
+	periods = 1;
+	measured = 0;
+	running = started = false;
+	first = last = 0;
+	shortest = longest = 0;
+}
+
+void AD9833FreqMeter :: Start ( uint16_t periods ) {
+	running = false;
+	this->periods = periods ? periods : 1;
+	measured = 0;
+	started = false;
+	shortest = 0xFFFFFFFFUL;
+	longest = 0;
+	running = true;
+}
+
+void AD9833FreqMeter :: Stop ( void ) {
+	running = false;
+	measured = 0;
+}
+
+/*
+ * Keep the first and the latest edge, and the extremes of the single
+ * periods. Unsigned differences take care of the timer wrapping.
+ */
+void AD9833FreqMeter :: Capture ( uint32_t timestamp ) {
+	if ( !running ) return;
+	if ( !started ) {
+		first = timestamp;
+		started = true;
+	}
+	else {
+		uint32_t period = timestamp - last;
+		if ( period < shortest ) shortest = period;
+		if ( period > longest ) longest = period;
+		measured++;
+	}
+	last = timestamp;
+	if ( measured == periods ) running = false;		// Publish last
+}
+
+bool AD9833FreqMeter :: Ready ( void ) {
+	return !running && measured == periods;
+}
+
+float AD9833FreqMeter :: GetPeriodTicks ( void ) {
+	if ( !Ready() ) return 0;
+	return (float)(last - first) / periods;
+}
+
+float AD9833FreqMeter :: GetPeriod ( void ) {
+	return GetPeriodTicks() / timerClock;
+}
+
+float AD9833FreqMeter :: GetFrequency ( void ) {
+	if ( !Ready() || last == first ) return 0;
+	return (float)timerClock * periods / (float)(last - first);
+}
+
+uint32_t AD9833FreqMeter :: GetJitterTicks ( void ) {
+	return Ready() ? longest - shortest : 0;
+}
+
+/*
+ * Worked out from the tick counts rather than from GetFrequency, so
+ * the float rounding is that of one division
+ */
+float AD9833FreqMeter :: GetDeviation ( float expectedHz ) {
+	if ( !Ready() || expectedHz <= 0 ) return 0;
+	float expectedTicks = (float)timerClock * periods / expectedHz;
+	return (expectedTicks - (float)(last - first)) / (float)(last - first);
+}
+
+bool AD9833FreqMeter :: Verify ( AD9833 &gen, Registers reg, float tolerance ) {
+	if ( !Ready() ) return false;
+	float deviation = GetDeviation(gen.GetActualProgrammedFrequency(reg));
+	return deviation >= -tolerance && deviation <= tolerance;
+}
+
+/*
+ * The output is freqWord * reference / 2^28, so a reference that is
+ * off by some ppm makes every frequency off by the same ppm
+ */
+uint32_t AD9833FreqMeter :: GetCorrectedReference ( AD9833 &gen, Registers reg ) {
+	uint32_t reference = gen.GetReferenceFrequency();
+	if ( !Ready() ) return reference;
+	float deviation = GetDeviation(gen.GetActualProgrammedFrequency(reg));
+	float correction = reference * deviation;
+	return reference + (int32_t)(correction < 0 ? correction - 0.5f : correction + 0.5f);
+}
+
+uint32_t AD9833FreqMeter :: Calibrate ( AD9833 &gen, Registers reg ) {
+	uint32_t reference = GetCorrectedReference(gen,reg);
+	gen.SetReferenceFrequency(reference);
+	return reference;
+}
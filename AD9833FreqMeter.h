@@ -0,0 +1,110 @@
+/*
+ * AD9833FreqMeter.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef __AD9833_FREQ_METER__
+
+#define __AD9833_FREQ_METER__
+
+#include "AD9833.h"
+
+#ifndef METER_TIMER_CLOCK
+#ifdef F_CPU
+#define METER_TIMER_CLOCK	F_CPU		// Timer1 with no prescaler
+#else
+#define METER_TIMER_CLOCK	16000000UL
+#endif
+#endif
+
+/*
+ * Frequency meter for checking the AD9833 output on the board itself.
+ * Wire the square wave (SQUARE_WAVE or HALF_SQUARE_WAVE, which drive
+ * VOUT rail to rail) to a timer input capture pin; the capture
+ * interrupt passes the timer count at each rising edge to Capture.
+ * AD9833InputCapture.h does this with Timer1 on AVR.
+ *
+ * The mean period is the time from the first to the last of 'periods'
+ * periods, so the resolution is one timer clock over the whole
+ * measurement: 1000 periods of 10 kHz at 16 MHz resolve 0.6 ppm.
+ *
+ * The measurement is only as good as the timer clock. A crystal is
+ * good to tens of ppm; a ceramic resonator (as on the Uno) only to
+ * 0.1 - 0.5%. Give the clock's true frequency to the constructor if
+ * it is known.
+ *
+ *	meter.Start(1000);
+ *	while ( !meter.Ready() ) ;
+ *	if ( !meter.Verify(gen,REG0,100e-6) )		// Within 100 ppm?
+ *		meter.Calibrate(gen,REG0);				// Correct later encodes
+ */
+class AD9833FreqMeter {
+
+public:
+
+	AD9833FreqMeter ( uint32_t timerClockHz = METER_TIMER_CLOCK );
+
+	// Measure over the next 'periods' periods (1 or more)
+	void Start ( uint16_t periods );
+
+	// Stop measuring. Ready stays false.
+	void Stop ( void );
+
+	// Timer count at a rising edge. Call from the capture interrupt.
+	// The count may wrap at 2^32.
+	void Capture ( uint32_t timestamp );
+
+	// True once the periods have been measured
+	bool Ready ( void );
+
+	// Mean period in timer clocks and seconds, and the frequency in Hz
+	float GetPeriodTicks ( void );
+	float GetPeriod ( void );
+	float GetFrequency ( void );
+
+	// Longest less shortest single period, in timer clocks
+	uint32_t GetJitterTicks ( void );
+
+	// Measured frequency / expectedHz - 1 (2.5e-5: 25 ppm fast)
+	float GetDeviation ( float expectedHz );
+
+	// True if gen's output (GetActualProgrammedFrequency(reg)) was
+	// measured within +/- tolerance (a fraction: 1e-4 is 100 ppm)
+	bool Verify ( AD9833 &gen, Registers reg, float tolerance );
+
+	// The reference frequency that explains the deviation from gen's
+	// output. Calibrate also makes gen use it (SetReferenceFrequency)
+	// and returns it; set the frequencies again for it to take effect.
+	uint32_t GetCorrectedReference ( AD9833 &gen, Registers reg );
+	uint32_t Calibrate ( AD9833 &gen, Registers reg );
+
+private:
+
+	uint32_t		timerClock;
+	uint16_t		periods;
+	volatile uint16_t	measured;	// Periods so far
+	volatile bool	running;
+	bool			started;		// First edge seen
+	uint32_t		first, last;
+	uint32_t		shortest, longest;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * AD9833FreqPlan.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * Frequency plans: fixed lists of frequencies (scales, channel plans,
+ * calibration points) encoded by the compiler into flash. Each entry is
+ * the two SPI words that load a frequency register, so playing an entry
+ * is two flash reads and the SPI writes. For example:
+ *
+ *	const AD9833FreqEntry scale[] PROGMEM = {
+ *		AD9833PlanEntry(261.63), AD9833PlanEntry(293.66),
+ *		AD9833PlanEntry(329.63), AD9833PlanEntry(349.23)
+ *	};
+ *	AD9833FreqPlan plan(gen,scale,AD9833_PLAN_SIZE(scale));
+ *	...
+ *	plan.Play(2);
+ *
+ * The reference frequency is an argument of AD9833PlanEntry (25 MHz by
+ * default); it must match the one given to the AD9833 constructor.
+ */
+
+#ifndef __AD9833_FREQ_PLAN__
+
+#define __AD9833_FREQ_PLAN__
+
+#include "AD9833.h"
+#include "AD9833Fast.h"
+
+// One plan entry: the LSB and MSB writes of a frequency register
+typedef struct {
+	uint16_t	lsb;
+	uint16_t	msb;
+} AD9833FreqEntry;
+
+#define AD9833_PLAN_SIZE(table)		(sizeof(table) / sizeof(AD9833FreqEntry))
+
+// Entry for frequencyHz in freqReg. Evaluated by the compiler.
+constexpr AD9833FreqEntry AD9833PlanEntry ( float frequencyHz,
+		Registers freqReg = REG0, uint32_t refHz = 25000000UL ) {
+	return { AD9833FreqLSB(AD9833FrequencyWord(frequencyHz,refHz),freqReg),
+			 AD9833FreqMSB(AD9833FrequencyWord(frequencyHz,refHz),freqReg) };
+}
+
+/*
+ * Plays the entries of a plan table in PROGMEM on an AD9833. Entries
+ * that are already in the frequency register are not sent again.
+ */
+class AD9833FreqPlan {
+
+public:
+
+	AD9833FreqPlan ( AD9833 &gen, const AD9833FreqEntry *table, uint16_t count ) :
+		gen(gen), table(table), count(count), index(0) { }
+
+	// Load entry 'entry' into its frequency register
+	void Play ( uint16_t entry ) {
+		index = entry;
+		AD9833FreqEntry e = Read(table,entry);
+		gen.SetFrequencyWords(e.lsb,e.msb);
+	}
+
+	// Play the entry after the last one played, wrapping at the end
+	void Next ( void ) {
+		Play(index + 1 < count ? index + 1 : 0);
+	}
+
+	uint16_t GetIndex ( void ) { return index; }
+	uint16_t GetCount ( void ) { return count; }
+
+	// Copy an entry out of flash, e.g. for AD9833Fast::Write(lsb,msb)
+	static AD9833FreqEntry Read ( const AD9833FreqEntry *table, uint16_t entry ) {
+		AD9833FreqEntry e;
+		e.lsb = pgm_read_word(&table[entry].lsb);
+		e.msb = pgm_read_word(&table[entry].msb);
+		return e;
+	}
+
+private:
+
+	AD9833					&gen;
+	const AD9833FreqEntry	*table;
+	uint16_t				count;
+	uint16_t				index;
+};
+
+#endif
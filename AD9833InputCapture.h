@@ -0,0 +1,94 @@
+/*
+ * AD9833InputCapture.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * Timer1 input capture for AD9833FreqMeter on AVR. Timer1 runs free at
+ * the CPU clock; the capture interrupt extends the 16 bit count of each
+ * rising edge on the ICP1 pin (8 on an Uno or Nano, 4 on a Leonardo or
+ * Micro) to 32 bits and passes it to the meter. The noise canceler is
+ * on, which delays every edge by the same 4 clocks.
+ *
+ * One interrupt per period: up to about 50 kHz at 16 MHz. Measure
+ * higher frequencies with a lower test frequency, or HALF_SQUARE_WAVE.
+ *
+ * This header defines the Timer1 capture and overflow interrupts, so
+ * include it in exactly ONE file of a sketch, and not together with
+ * AD9833Timer1.h or another library that uses Timer1.
+ */
+
+#ifndef __AD9833_INPUT_CAPTURE__
+
+#define __AD9833_INPUT_CAPTURE__
+
+#if !defined(__AVR__)
+#error "AD9833InputCapture.h is for AVR boards. Call AD9833FreqMeter::Capture from your own capture interrupt."
+#endif
+
+#include "AD9833FreqMeter.h"
+#include <avr/interrupt.h>
+
+class AD9833InputCapture {
+
+public:
+
+	// Start Timer1 and pass each rising edge on ICP1 to 'meter'. Call
+	// meter.Start to begin a measurement.
+	static void Begin ( AD9833FreqMeter &meter ) {
+		End();
+		AD9833InputCapture::meter = &meter;
+		overflows = 0;
+		TCCR1A = 0;
+		TCNT1 = 0;
+		TIFR1 = _BV(ICF1) | _BV(TOV1);			// Clear anything pending
+		TCCR1B = _BV(ICNC1) | _BV(ICES1) | _BV(CS10);	// Rising, clock / 1
+		TIMSK1 |= _BV(ICIE1) | _BV(TOIE1);
+	}
+
+	static void End ( void ) {
+		TIMSK1 &= ~(_BV(ICIE1) | _BV(TOIE1));
+		TCCR1B = 0;
+	}
+
+	// Called by the capture interrupt
+	static void OnCapture ( void ) {
+		uint16_t low = ICR1;
+		uint16_t high = overflows;
+		// An overflow just before the capture whose interrupt has not
+		// run yet (this one came first)
+		if ( (TIFR1 & _BV(TOV1)) && low < 0x8000 ) high++;
+		meter->Capture(((uint32_t)high << 16) | low);
+	}
+
+	static AD9833FreqMeter * volatile	meter;
+	static volatile uint16_t			overflows;
+};
+
+AD9833FreqMeter * volatile AD9833InputCapture::meter = NULL;
+volatile uint16_t AD9833InputCapture::overflows = 0;
+
+ISR(TIMER1_CAPT_vect) {
+	AD9833InputCapture::OnCapture();
+}
+
+ISR(TIMER1_OVF_vect) {
+	AD9833InputCapture::overflows++;
+}
+
+#endif
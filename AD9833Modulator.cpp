@@ -0,0 +1,165 @@
+/*
+ * AD9833Modulator.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+#include "AD9833Modulator.h"
+
+#define MODULATOR_MASK		(MODULATOR_BUFFER_SIZE - 1)
+
+#if (MODULATOR_BUFFER_SIZE & MODULATOR_MASK) || MODULATOR_BUFFER_SIZE > 256
+#error "MODULATOR_BUFFER_SIZE must be a power of 2, 256 or less"
+#endif
+
+AD9833Modulator :: AD9833Modulator ( AD9833 &gen ) : gen(gen) {
+	running = false;
+	head = tail = 0;
+	underruns = 0;
+	lastSymbol = 0;
+}
+
+/*
+ * Frequency shift keying: symbol 0 outputs freq0Hz, symbol 1 outputs
+ * freq1Hz. Both use phase register 0.
+ */
+void AD9833Modulator :: SetupFSK ( WaveformType waveType, float freq0Hz,
+		float freq1Hz ) {
+	Setup(waveType,freq0Hz,freq1Hz,0.0,0.0);
+}
+
+/*
+ * Phase shift keying: symbol 0 outputs phase0Deg, symbol 2 outputs
+ * phase1Deg (bit 1 of the symbol selects the phase register)
+ */
+void AD9833Modulator :: SetupPSK ( WaveformType waveType, float freqHz,
+		float phase0Deg, float phase1Deg ) {
+	Setup(waveType,freqHz,freqHz,phase0Deg,phase1Deg);
+}
+
+/*
+ * Preload both register sets. Bit 0 of a symbol selects the frequency
+ * register and bit 1 selects the phase register, so all four symbols
+ * can be used for combined FSK / PSK.
+ */
+void AD9833Modulator :: Setup ( WaveformType waveType, float freq0Hz,
+		float freq1Hz, float phase0Deg, float phase1Deg ) {
+	Stop();
+	gen.BeginUpdate();
+	gen.SetFrequency(REG0,freq0Hz);
+	gen.SetFrequency(REG1,freq1Hz);
+	gen.SetPhase(REG0,phase0Deg);
+	gen.SetPhase(REG1,phase1Deg);
+	gen.SetWaveform(REG0,waveType);
+	gen.SetWaveform(REG1,waveType);
+	gen.CommitUpdate();
+}
+
+/*
+ * Precompute the four control words and start taking symbols on Tick
+ */
+void AD9833Modulator :: Start ( void ) {
+	running = false;
+	for ( uint8_t symbol = 0; symbol < 4; symbol++ )
+		controlWord[symbol] = gen.GetControlWord(symbol & 1 ? REG1 : REG0,
+			symbol & 2 ? REG1 : REG0);
+	gen.WriteControlWord(controlWord[lastSymbol]);
+	running = true;
+}
+
+/*
+ * Stop taking symbols. The output stays on the last symbol sent, and
+ * any symbols still in the buffer are kept.
+ */
+void AD9833Modulator :: Stop ( void ) {
+	running = false;
+}
+
+/*
+ * Queue one symbol. Returns false if the buffer is full.
+ */
+bool AD9833Modulator :: Write ( uint8_t symbol ) {
+	uint8_t next = (head + 1) & MODULATOR_MASK;
+	if ( next == tail ) return false;		// Full
+	buffer[head] = symbol & 0x03;
+	head = next;							// Publish after the store
+	return true;
+}
+
+/*
+ * Queue as many symbols as fit. Returns how many were queued.
+ */
+uint16_t AD9833Modulator :: Write ( const uint8_t *symbols, uint16_t count ) {
+	uint16_t written = 0;
+	while ( written < count && Write(symbols[written]) )
+		written++;
+	return written;
+}
+
+/*
+ * Queue the bits of 'data', most significant first, as symbols 0 / 1
+ * (for FSK) or 0 / 2 (for PSK, bit 1 selects the phase register)
+ */
+bool AD9833Modulator :: WriteByte ( uint8_t data, bool psk ) {
+	if ( AvailableForWrite() < 8 ) return false;
+	for ( uint8_t bit = 0x80; bit; bit >>= 1 ) {
+		uint8_t symbol = (data & bit) ? 1 : 0;
+		Write(psk ? symbol << 1 : symbol);
+	}
+	return true;
+}
+
+/*
+ * Free space in the symbol buffer
+ */
+uint16_t AD9833Modulator :: AvailableForWrite ( void ) {
+	return (uint8_t)(tail - head - 1) & MODULATOR_MASK;
+}
+
+/*
+ * Symbols waiting to be sent
+ */
+uint16_t AD9833Modulator :: Pending ( void ) {
+	return (uint8_t)(head - tail) & MODULATOR_MASK;
+}
+
+/*
+ * Number of Ticks that found the buffer empty (the output held the
+ * last symbol)
+ */
+uint16_t AD9833Modulator :: GetUnderruns ( void ) {
+	return underruns;
+}
+
+/*
+ * Output the next symbol: one control word, or nothing if the symbol
+ * is the same as the last one. Call from a timer interrupt at the
+ * symbol rate.
+ */
+void AD9833Modulator :: Tick ( void ) {
+	if ( !running ) return;
+	uint8_t t = tail;
+	if ( t == head ) {
+		underruns++;
+		return;
+	}
+	lastSymbol = buffer[t];
+	tail = (t + 1) & MODULATOR_MASK;		// Release the slot
+	gen.WriteControlWord(controlWord[lastSymbol]);
+}
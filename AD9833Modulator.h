@@ -0,0 +1,104 @@
+/*
+ * AD9833Modulator.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef __AD9833_MODULATOR__
+
+#define __AD9833_MODULATOR__
+
+#include "AD9833.h"
+
+#ifndef MODULATOR_BUFFER_SIZE
+#define MODULATOR_BUFFER_SIZE	64		// Symbols. Must be a power of 2.
+#endif
+
+/*
+ * Streaming FSK / PSK modulator. REG0 and REG1 are loaded once; after
+ * that each symbol only switches the FSEL / PSEL bits, which is a
+ * single control word. Symbols are queued from loop() with Write and
+ * taken from a single producer / single consumer ring buffer by Tick,
+ * which is called from a timer interrupt at the symbol rate.
+ *
+ * A symbol is 0 - 3: bit 0 selects the frequency register and bit 1
+ * the phase register.
+ *
+ * While running, Tick writes to the AD9833 from interrupt context, so
+ * leave the other AD9833 functions alone until Stop has been called.
+ */
+class AD9833Modulator {
+
+public:
+
+	AD9833Modulator ( AD9833 &gen );
+
+	// Load the registers for FSK (symbol 0 = freq0Hz, 1 = freq1Hz)
+	void SetupFSK ( WaveformType waveType, float freq0Hz, float freq1Hz );
+
+	// Load the registers for PSK (symbol 0 = phase0Deg, 2 = phase1Deg)
+	void SetupPSK ( WaveformType waveType, float freqHz,
+		float phase0Deg, float phase1Deg );
+
+	// Load both register sets for combined FSK / PSK
+	void Setup ( WaveformType waveType, float freq0Hz, float freq1Hz,
+		float phase0Deg, float phase1Deg );
+
+	// Begin sending queued symbols on Tick. Call after any change to
+	// the waveform, output enable, sleep or DAC settings.
+	void Start ( void );
+
+	// Stop sending. The output stays on the last symbol.
+	void Stop ( void );
+
+	// Queue symbols. Return false / the number queued if the buffer
+	// fills up. Called from loop() (the single producer).
+	bool Write ( uint8_t symbol );
+	uint16_t Write ( const uint8_t *symbols, uint16_t count );
+
+	// Queue the 8 bits of data, MSB first, as FSK (0/1) or PSK (0/2)
+	// symbols. Returns false, queuing nothing, if there is no room.
+	bool WriteByte ( uint8_t data, bool psk = false );
+
+	// Free space in, and symbols waiting in, the buffer
+	uint16_t AvailableForWrite ( void );
+	uint16_t Pending ( void );
+
+	// Ticks that found no symbol waiting
+	uint16_t GetUnderruns ( void );
+
+	// Send the next symbol. Call from a timer interrupt (the single
+	// consumer).
+	void Tick ( void );
+
+private:
+
+	AD9833			&gen;
+	uint16_t		controlWord[4];
+	volatile bool	running;
+
+	uint8_t			buffer[MODULATOR_BUFFER_SIZE];
+	volatile uint8_t	head;		// Written only by Write
+	volatile uint8_t	tail;		// Written only by Tick
+	volatile uint16_t	underruns;
+	uint8_t			lastSymbol;
+};
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * AD9833Remote.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+#include "AD9833Remote.h"
+
+#define REMOTE_WAIT_SYNC		0
+#define REMOTE_WAIT_LENGTH		1
+#define REMOTE_WAIT_BODY		2
+#define REMOTE_WAIT_CRC			3
+
+#define REMOTE_MAX_PING			8		// Bytes a PING may carry
+
+// Argument bytes of the commands that Apply handles, by command
+static const uint8_t argumentBytes[] = { 0, 5, 3, 2, 2, 1, 0 };
+
+static const WaveformType waveforms[] = { SINE_WAVE, TRIANGLE_WAVE,
+	SQUARE_WAVE, HALF_SQUARE_WAVE };
+
+static uint32_t Read32 ( const uint8_t *data ) {
+	return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+		((uint32_t)data[2] << 8) | data[3];
+}
+
+AD9833Remote :: AD9833Remote ( AD9833 &gen, AD9833RemoteWriter writer ) :
+		gen(gen), writer(writer) {
+	head = tail = 0;
+	overrun = false;
+	state = REMOTE_WAIT_SYNC;
+	length = received = crc = 0;
+	stepCount = step = 0;
+	stepReg = REG0;
+	stepRepeat = stepping = false;
+	dwellMicros = stepMicros = 0;
+	framesApplied = framesRejected = bytesLost = 0;
+}
+
+/*
+ * Producer side of the ring buffer. Only writes head.
+ */
+void AD9833Remote :: Receive ( uint8_t data ) {
+	uint8_t next = (head + 1) & (REMOTE_BUFFER_SIZE - 1);
+	if ( next == tail ) {
+		overrun = true;
+		bytesLost++;
+		return;
+	}
+	buffer[head] = data;
+	head = next;
+}
+
+uint8_t AD9833Remote :: CRC8 ( uint8_t crc, uint8_t data ) {
+	crc ^= data;
+	for ( uint8_t bit = 0; bit < 8; bit++ )
+		crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+	return crc;
+}
+
+/*
+ * Consumer side: decode whatever has arrived. Every frame found is
+ * applied inside one BeginUpdate, so a burst of commands costs one SPI
+ * transaction (or one per UPDATE_BUFFER_SIZE words).
+ */
+uint8_t AD9833Remote :: Poll ( void ) {
+	uint8_t frames = 0;
+	gen.Poll();							// Finish a REMOTE_RESET
+	gen.BeginUpdate();
+
+	while ( tail != head ) {
+		uint8_t data = buffer[tail];
+		tail = (tail + 1) & (REMOTE_BUFFER_SIZE - 1);
+
+		switch ( state ) {
+			case REMOTE_WAIT_SYNC:
+				if ( data == REMOTE_SYNC ) state = REMOTE_WAIT_LENGTH;
+				break;
+
+			case REMOTE_WAIT_LENGTH:
+				if ( data == 0 || data > REMOTE_MAX_FRAME ) {
+					framesRejected++;		// Resynchronize on the next SYNC
+					state = REMOTE_WAIT_SYNC;
+					break;
+				}
+				length = data;
+				received = 0;
+				crc = CRC8(0,data);
+				state = REMOTE_WAIT_BODY;
+				break;
+
+			case REMOTE_WAIT_BODY:
+				frame[received++] = data;
+				crc = CRC8(crc,data);
+				if ( received == length ) state = REMOTE_WAIT_CRC;
+				break;
+
+			default:						// REMOTE_WAIT_CRC
+				state = REMOTE_WAIT_SYNC;
+				if ( data != crc ) {
+					framesRejected++;
+					Reply(REMOTE_ERROR,REMOTE_BAD_CRC);
+					break;
+				}
+				Frame();
+				frames++;
+				break;
+		}
+	}
+
+	StepSequence();
+	gen.CommitUpdate();
+	return frames;
+}
+
+/*
+ * Apply a frame that passed its CRC and answer it
+ */
+void AD9833Remote :: Frame ( void ) {
+	uint8_t command = frame[0] & REMOTE_COMMAND_MASK;
+	const uint8_t *args = frame + 1;
+	uint8_t argLength = length - 1;
+	uint8_t status = REMOTE_OK;
+	uint8_t used;
+
+	switch ( command ) {
+		case REMOTE_PING:
+			if ( argLength > REMOTE_MAX_PING ) status = REMOTE_BAD_LENGTH;
+			break;
+
+		case REMOTE_BATCH:
+			for ( uint8_t at = 0; at < argLength && status == REMOTE_OK; at += used )
+				status = Apply(args + at,argLength - at,used);
+			break;
+
+		case REMOTE_SEQUENCE:
+			status = StartSequence(args,argLength);
+			break;
+
+		case REMOTE_STOP:
+			stepping = false;
+			if ( argLength != 0 ) status = REMOTE_BAD_LENGTH;
+			break;
+
+		default:
+			status = Apply(frame,length,used);
+			if ( status == REMOTE_OK && used != length ) status = REMOTE_BAD_LENGTH;
+			break;
+	}
+
+	if ( status == REMOTE_OK ) framesApplied++;
+	else framesRejected++;
+	if ( status == REMOTE_OK && overrun ) status = REMOTE_OVERRUN;
+	overrun = false;
+
+	if ( !(frame[0] & REMOTE_NO_REPLY) ) {
+		if ( command == REMOTE_PING && status != REMOTE_BAD_LENGTH )
+			Reply(command,status,args,argLength);
+		else
+			Reply(command,status);
+	}
+}
+
+/*
+ * Apply one register command (command byte, then arguments). 'used' is
+ * set to the bytes it takes up.
+ */
+uint8_t AD9833Remote :: Apply ( const uint8_t *args, uint8_t length, uint8_t &used ) {
+	uint8_t command = args[0] & REMOTE_COMMAND_MASK;
+	used = length;
+	if ( command < REMOTE_FREQ_WORD || command > REMOTE_RESET )
+		return REMOTE_BAD_COMMAND;
+	used = 1 + argumentBytes[command];
+	if ( used > length ) return REMOTE_BAD_LENGTH;
+
+	args++;
+	bool hasReg = command <= REMOTE_OUTPUT;	// First argument is a register
+	if ( hasReg && args[0] > 1 ) return REMOTE_BAD_ARGUMENT;
+	Registers reg = hasReg && args[0] ? REG1 : REG0;
+
+	switch ( command ) {
+		case REMOTE_FREQ_WORD: {
+			uint32_t word = Read32(args + 1);
+			if ( word > FREQ_WORD_MASK ) return REMOTE_BAD_ARGUMENT;
+			gen.SetFrequencyWord(reg,word);
+			break;
+		}
+		case REMOTE_PHASE_WORD: {
+			uint16_t word = ((uint16_t)args[1] << 8) | args[2];
+			if ( word > 0x0FFF ) return REMOTE_BAD_ARGUMENT;
+			gen.SetPhaseWord(reg,word);
+			break;
+		}
+		case REMOTE_WAVEFORM:
+			if ( args[1] > 3 ) return REMOTE_BAD_ARGUMENT;
+			gen.SetWaveform(reg,waveforms[args[1]]);
+			break;
+		case REMOTE_OUTPUT:
+			if ( args[1] > 1 ) return REMOTE_BAD_ARGUMENT;
+			gen.SetOutputSource(reg,args[1] ? REG1 : REG0);
+			break;
+		case REMOTE_ENABLE:
+			gen.EnableOutput(args[0] != 0);
+			break;
+		default:							// REMOTE_RESET
+			gen.ResetAsync();
+			break;
+	}
+	return REMOTE_OK;
+}
+
+/*
+ * reg, dwell (4), repeat, then the frequency words. The first word is
+ * loaded now.
+ */
+uint8_t AD9833Remote :: StartSequence ( const uint8_t *args, uint8_t length ) {
+	if ( length < 10 || (length - 6) % 4 != 0 ||
+			(length - 6) / 4 > REMOTE_SEQUENCE_STEPS )
+		return REMOTE_BAD_LENGTH;
+	if ( args[0] > 1 ) return REMOTE_BAD_ARGUMENT;
+	uint8_t count = (length - 6) / 4;
+	for ( uint8_t i = 0; i < count; i++ )
+		if ( Read32(args + 6 + 4 * i) > FREQ_WORD_MASK ) return REMOTE_BAD_ARGUMENT;
+	for ( uint8_t i = 0; i < count; i++ )
+		steps[i] = Read32(args + 6 + 4 * i);
+	stepReg = args[0] ? REG1 : REG0;
+	dwellMicros = Read32(args + 1);
+	stepRepeat = args[5] != 0;
+	stepCount = count;
+	step = 0;
+	stepping = true;
+	stepMicros = micros();
+	gen.SetFrequencyWord(stepReg,steps[0]);
+	return REMOTE_OK;
+}
+
+void AD9833Remote :: StepSequence ( void ) {
+	if ( !stepping || micros() - stepMicros < dwellMicros ) return;
+	stepMicros += dwellMicros;
+	if ( ++step == stepCount ) {
+		if ( !stepRepeat ) {
+			stepping = false;
+			return;
+		}
+		step = 0;
+	}
+	gen.SetFrequencyWord(stepReg,steps[step]);
+}
+
+void AD9833Remote :: Reply ( uint8_t command, uint8_t status,
+		const uint8_t *data, uint8_t count ) {
+	uint8_t reply[REMOTE_MAX_PING + 5];
+	reply[0] = REMOTE_SYNC;
+	reply[1] = count + 2;
+	reply[2] = command | REMOTE_REPLY;
+	reply[3] = status;
+	for ( uint8_t i = 0; i < count; i++ ) reply[4 + i] = data[i];
+	uint8_t crc = 0;
+	for ( uint8_t i = 1; i < count + 4; i++ ) crc = CRC8(crc,reply[i]);
+	reply[count + 4] = crc;
+	writer(reply,count + 5);
+}
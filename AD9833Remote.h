@@ -0,0 +1,151 @@
+/*
+ * AD9833Remote.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * Binary serial command protocol for driving an AD9833 from a PC. The
+ * commands carry register words, so the board does no float math.
+ *
+ * Frame:	REMOTE_SYNC, length, command, arguments..., CRC-8
+ *	length counts the command and argument bytes. The CRC (polynomial
+ *	0x07) covers length, command and arguments. Values are MSB first.
+ *
+ * Commands (arguments in bytes):
+ *	REMOTE_PING			data (0 - 8)		reply echoes the data
+ *	REMOTE_FREQ_WORD	reg, word (4)		SetFrequencyWord
+ *	REMOTE_PHASE_WORD	reg, word (2)		SetPhaseWord
+ *	REMOTE_WAVEFORM		reg, type (0 - 3)	SetWaveform: sine, triangle,
+ *											square, half square
+ *	REMOTE_OUTPUT		freqReg, phaseReg	SetOutputSource
+ *	REMOTE_ENABLE		0 / 1				EnableOutput
+ *	REMOTE_RESET							ResetAsync
+ *	REMOTE_BATCH		commands...			any of the above except PING,
+ *											each as command, arguments;
+ *											sent in one SPI transaction
+ *	REMOTE_SEQUENCE		reg, dwell (4), repeat, words (4 each)
+ *											step reg through the words,
+ *											dwell usec each, from Poll
+ *	REMOTE_STOP								stop a sequence
+ *
+ * Each frame is answered with REMOTE_REPLY | command and a status byte
+ * (PING adds its data), unless the command has REMOTE_NO_REPLY set.
+ * A frame that fails its CRC is answered with REMOTE_ERROR.
+ *
+ * Bytes are handed to Receive, normally from the UART receive interrupt
+ * (see AD9833RemoteUSART.h for AVR), into a ring buffer. Poll, called
+ * from loop(), decodes the frames waiting there and applies all of them
+ * inside one BeginUpdate / CommitUpdate.
+ *
+ * extras/linux has the PC side client (AD9833Client) and a benchmark.
+ */
+
+#ifndef __AD9833_REMOTE__
+
+#define __AD9833_REMOTE__
+
+#include "AD9833.h"
+
+#ifndef REMOTE_BUFFER_SIZE
+#define REMOTE_BUFFER_SIZE		64		// Received bytes. Must be a power of 2.
+#endif
+#ifndef REMOTE_MAX_FRAME
+#define REMOTE_MAX_FRAME		48		// Command and argument bytes
+#endif
+#ifndef REMOTE_SEQUENCE_STEPS
+#define REMOTE_SEQUENCE_STEPS	8		// Frequency words in a sequence
+#endif
+
+#define REMOTE_SYNC				0xA5
+
+#define REMOTE_PING				0x00
+#define REMOTE_FREQ_WORD		0x01
+#define REMOTE_PHASE_WORD		0x02
+#define REMOTE_WAVEFORM			0x03
+#define REMOTE_OUTPUT			0x04
+#define REMOTE_ENABLE			0x05
+#define REMOTE_RESET			0x06
+#define REMOTE_BATCH			0x07
+#define REMOTE_SEQUENCE			0x08
+#define REMOTE_STOP				0x09
+#define REMOTE_COMMAND_MASK		0x3F
+#define REMOTE_REPLY			0x40	// Set in replies
+#define REMOTE_NO_REPLY			0x80	// Set in a command: do not answer
+#define REMOTE_ERROR			0x7F	// Reply to a frame with a bad CRC
+
+// Reply status
+#define REMOTE_OK				0
+#define REMOTE_BAD_CRC			1
+#define REMOTE_BAD_COMMAND		2
+#define REMOTE_BAD_LENGTH		3
+#define REMOTE_BAD_ARGUMENT		4
+#define REMOTE_OVERRUN			5		// Bytes were lost before this frame
+
+// Sends reply bytes back to the PC
+typedef void (*AD9833RemoteWriter) ( const uint8_t *data, uint8_t count );
+
+class AD9833Remote {
+
+public:
+
+	AD9833Remote ( AD9833 &gen, AD9833RemoteWriter writer );
+
+	// Add a received byte. Interrupt safe (single producer).
+	void Receive ( uint8_t data );
+
+	// Decode and apply the frames received so far, and step a running
+	// sequence. Returns the number of frames handled. Call from loop().
+	uint8_t Poll ( void );
+
+	// CRC-8, polynomial 0x07, as used by the frames
+	static uint8_t CRC8 ( uint8_t crc, uint8_t data );
+
+	uint32_t		framesApplied;
+	uint32_t		framesRejected;
+	uint32_t		bytesLost;			// Ring buffer overruns
+
+private:
+
+	void			Frame ( void );
+	uint8_t			Apply ( const uint8_t *args, uint8_t length, uint8_t &used );
+	uint8_t			StartSequence ( const uint8_t *args, uint8_t length );
+	void			StepSequence ( void );
+	void			Reply ( uint8_t command, uint8_t status,
+						const uint8_t *data = NULL, uint8_t count = 0 );
+
+	AD9833				&gen;
+	AD9833RemoteWriter	writer;
+
+	volatile uint8_t	buffer[REMOTE_BUFFER_SIZE];
+	volatile uint8_t	head, tail;
+	volatile bool		overrun;
+
+	// Frame being decoded
+	uint8_t			state;
+	uint8_t			frame[REMOTE_MAX_FRAME];
+	uint8_t			length, received, crc;
+
+	// Sequence
+	uint32_t		steps[REMOTE_SEQUENCE_STEPS];
+	uint8_t			stepCount, step;
+	Registers		stepReg;
+	bool			stepRepeat, stepping;
+	uint32_t		dwellMicros, stepMicros;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * AD9833RemoteUSART.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * USART0 driver for AD9833Remote on AVR. The receive interrupt hands
+ * each byte straight to AD9833Remote::Receive, and replies are sent by
+ * polling, so baud rates up to F_CPU / 8 (2 Mbaud at 16 MHz) work.
+ *
+ * This header defines the USART0 receive interrupt, so include it in
+ * exactly ONE file of a sketch and do not use Serial (HardwareSerial
+ * defines the same interrupt).
+ *
+ *	AD9833Remote remote(gen,AD9833RemoteUSART::Write);
+ *	AD9833RemoteUSART::Begin(remote,1000000);
+ *	...
+ *	loop() { remote.Poll(); }
+ */
+
+#ifndef __AD9833_REMOTE_USART__
+
+#define __AD9833_REMOTE_USART__
+
+#if !defined(__AVR__)
+#error "AD9833RemoteUSART.h is for AVR boards. Call AD9833Remote::Receive from your UART interrupt."
+#endif
+
+#include "AD9833Remote.h"
+#include <avr/interrupt.h>
+
+#if defined(USART_RX_vect)
+	#define REMOTE_USART_RX_vect	USART_RX_vect		// ATmega328P and friends
+#else
+	#define REMOTE_USART_RX_vect	USART0_RX_vect		// ATmega2560, 1284P
+#endif
+
+class AD9833RemoteUSART {
+
+public:
+
+	// 8N1 at 'baud' (double speed mode), receive interrupt on
+	static void Begin ( AD9833Remote &remote, uint32_t baud ) {
+		AD9833RemoteUSART::remote = &remote;
+		uint16_t ubrr = (F_CPU / 4 / baud - 1) / 2;		// Rounded
+		UBRR0H = ubrr >> 8;
+		UBRR0L = ubrr;
+		UCSR0A = _BV(U2X0);
+		UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);
+		UCSR0B = _BV(RXEN0) | _BV(TXEN0) | _BV(RXCIE0);
+	}
+
+	// AD9833RemoteWriter: send the reply bytes, waiting for room
+	static void Write ( const uint8_t *data, uint8_t count ) {
+		while ( count-- ) {
+			while ( !(UCSR0A & _BV(UDRE0)) ) ;
+			UDR0 = *data++;
+		}
+	}
+
+	static AD9833Remote * volatile remote;
+};
+
+AD9833Remote * volatile AD9833RemoteUSART::remote = NULL;
+
+ISR(REMOTE_USART_RX_vect) {
+	uint8_t data = UDR0;
+	AD9833Remote *r = AD9833RemoteUSART::remote;
+	if ( r ) r->Receive(data);
+}
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * AD9833SAMD21DMA.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * AD9833AsyncSPI engine for SAMD21 boards (Zero, M0, MKR): one DMA
+ * channel writes a whole frame into the SPI SERCOM's DATA register, so
+ * there is one interrupt per frame instead of one per byte.
+ *
+ * The SERCOM is the one the SPI library uses: SERCOM4 on a Zero or M0,
+ * SERCOM1 on a MKR board. Pass it and its DMA trigger if it is not
+ * SERCOM4.
+ *
+ * This header defines the DMAC interrupt and takes over the DMA
+ * controller, so include it in exactly ONE file of a sketch, use only
+ * one AD9833SAMD21DMA and no other DMA library. Other SPI devices must
+ * not be used while it is Busy().
+ *
+ *	AD9833SAMD21DMA bus(FNC_PIN);				// Zero, M0
+ *	AD9833SAMD21DMA bus(FNC_PIN,SERCOM1,SERCOM1_DMAC_ID_TX);	// MKR
+ *	AD9833 gen(bus);
+ */
+
+#ifndef __AD9833_SAMD21_DMA__
+
+#define __AD9833_SAMD21_DMA__
+
+#if !defined(ARDUINO_ARCH_SAMD) || defined(__SAMD51__)
+#error "AD9833SAMD21DMA.h is for SAMD21 boards. Derive an engine from AD9833AsyncSPI."
+#endif
+
+#include "AD9833Async.h"
+
+#ifndef AD9833_DMA_CHANNEL
+#define AD9833_DMA_CHANNEL	0		// DMAC channel, 0 to 11
+#endif
+
+class AD9833SAMD21DMA : public AD9833AsyncSPI {
+
+public:
+
+	AD9833SAMD21DMA ( uint8_t FNCpin, Sercom *sercom = SERCOM4,
+		uint8_t trigger = SERCOM4_DMAC_ID_TX ) : AD9833AsyncSPI(FNCpin) {
+		this->sercom = sercom;
+		this->trigger = trigger;
+	}
+
+	// Called by the DMAC interrupt
+	static void OnDMAInterrupt ( void ) {
+		uint8_t channel = DMAC->CHID.reg;		// Restore for whoever we
+		DMAC->CHID.reg = DMAC_CHID_ID(AD9833_DMA_CHANNEL);	// interrupted
+		uint8_t flags = DMAC->CHINTFLAG.reg;
+		DMAC->CHINTFLAG.reg = flags;
+		DMAC->CHID.reg = channel;
+		if ( !(flags & DMAC_CHINTFLAG_TCMPL) ) return;
+
+		// The DMA is done when the last byte is in DATA, not when it
+		// is on the wire. FSYNC must stay LOW until then: 2 bytes at most.
+		Sercom *spi = instance->sercom;
+		while ( !spi->SPI.INTFLAG.bit.TXC ) ;
+
+		// Throw away what was clocked in, or the SPI library would read
+		// it as the reply to its next transfer
+		while ( spi->SPI.INTFLAG.bit.RXC ) (void)spi->SPI.DATA.reg;
+		spi->SPI.STATUS.reg = SERCOM_SPI_STATUS_BUFOVF;
+		spi->SPI.INTFLAG.reg = SERCOM_SPI_INTFLAG_ERROR;
+
+		SPI.endTransaction();
+		instance->TransferComplete();
+	}
+
+protected:
+
+	void BeginEngine ( void ) {
+		instance = this;
+		SPI.begin();
+
+		PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+		PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+		DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+		while ( DMAC->CTRL.reg & DMAC_CTRL_DMAENABLE ) ;
+		DMAC->BASEADDR.reg = (uint32_t)descriptors;
+		DMAC->WRBADDR.reg = (uint32_t)writeback;
+		DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+
+		// One beat per byte, whenever the SERCOM can take one
+		DMAC->CHID.reg = DMAC_CHID_ID(AD9833_DMA_CHANNEL);
+		DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+		DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+		while ( DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST ) ;
+		DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) |
+			DMAC_CHCTRLB_TRIGSRC(trigger) | DMAC_CHCTRLB_TRIGACT_BEAT;
+		DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+
+		NVIC_ClearPendingIRQ(DMAC_IRQn);
+		NVIC_EnableIRQ(DMAC_IRQn);
+	}
+
+	void StartTransfer ( const uint8_t *data, uint8_t count ) {
+		SPI.beginTransaction(SPISettings(AD9833_SPI_CLOCK,MSBFIRST,SPI_MODE2));
+
+		// With SRCINC the source address is that of the last beat + 1
+		DmacDescriptor *d = &descriptors[AD9833_DMA_CHANNEL];
+		d->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+			DMAC_BTCTRL_SRCINC | DMAC_BTCTRL_BLOCKACT_INT;
+		d->BTCNT.reg = count;
+		d->SRCADDR.reg = (uint32_t)(data + count);
+		d->DSTADDR.reg = (uint32_t)&sercom->SPI.DATA.reg;
+		d->DESCADDR.reg = 0;
+
+		uint8_t channel = DMAC->CHID.reg;
+		DMAC->CHID.reg = DMAC_CHID_ID(AD9833_DMA_CHANNEL);
+		DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+		DMAC->CHID.reg = channel;
+	}
+
+private:
+
+	Sercom			*sercom;
+	uint8_t			trigger;
+
+	static AD9833SAMD21DMA * volatile	instance;
+	// The DMAC reads channel n's descriptor from descriptors[n]
+	static DmacDescriptor	descriptors[AD9833_DMA_CHANNEL + 1] __attribute__((aligned(16)));
+	static DmacDescriptor	writeback[AD9833_DMA_CHANNEL + 1] __attribute__((aligned(16)));
+};
+
+AD9833SAMD21DMA * volatile AD9833SAMD21DMA::instance = NULL;
+DmacDescriptor AD9833SAMD21DMA::descriptors[AD9833_DMA_CHANNEL + 1];
+DmacDescriptor AD9833SAMD21DMA::writeback[AD9833_DMA_CHANNEL + 1];
+
+extern "C" void DMAC_Handler ( void ) {
+	AD9833SAMD21DMA::OnDMAInterrupt();
+}
+
+#endif
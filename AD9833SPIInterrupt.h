@@ -0,0 +1,93 @@
+/*
+ * AD9833SPIInterrupt.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * AD9833AsyncSPI engine for AVR: each byte is loaded from the SPI
+ * transfer complete interrupt, so only one byte is handled per
+ * interrupt and loop() runs in between.
+ *
+ * This header defines the SPI interrupt, so include it in exactly ONE
+ * file of a sketch, and only use one AD9833SPIInterrupt. Other SPI
+ * devices must not be used while it is Busy().
+ *
+ *	AD9833SPIInterrupt bus(FNC_PIN);
+ *	AD9833 gen(bus);
+ */
+
+#ifndef __AD9833_SPI_INTERRUPT__
+
+#define __AD9833_SPI_INTERRUPT__
+
+#if !defined(__AVR__)
+#error "AD9833SPIInterrupt.h is for AVR boards. Derive an engine from AD9833AsyncSPI."
+#endif
+
+#include "AD9833Async.h"
+#include <avr/interrupt.h>
+
+class AD9833SPIInterrupt : public AD9833AsyncSPI {
+
+public:
+
+	AD9833SPIInterrupt ( uint8_t FNCpin ) : AD9833AsyncSPI(FNCpin) { }
+
+	// Called by the SPI interrupt
+	static void OnByteSent ( void ) {
+		if ( remaining ) {
+			remaining--;
+			SPDR = *next++;
+			return;
+		}
+		SPCR &= ~_BV(SPIE);
+		SPI.endTransaction();
+		instance->TransferComplete();
+	}
+
+protected:
+
+	void BeginEngine ( void ) {
+		instance = this;
+		SPI.begin();
+	}
+
+	void StartTransfer ( const uint8_t *data, uint8_t count ) {
+		SPI.beginTransaction(SPISettings(AD9833_SPI_CLOCK,MSBFIRST,SPI_MODE2));
+		next = data + 1;
+		remaining = count - 1;
+		SPCR |= _BV(SPIE);
+		SPDR = data[0];
+	}
+
+private:
+
+	static AD9833SPIInterrupt * volatile	instance;
+	static const uint8_t * volatile		next;
+	static volatile uint8_t				remaining;
+};
+
+AD9833SPIInterrupt * volatile AD9833SPIInterrupt::instance = NULL;
+const uint8_t * volatile AD9833SPIInterrupt::next = NULL;
+volatile uint8_t AD9833SPIInterrupt::remaining = 0;
+
+ISR(SPI_STC_vect) {
+	AD9833SPIInterrupt::OnByteSent();
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * AD9833Sequence.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+#include "AD9833Sequence.h"
+
+/*
+ * Create a player for an AD9833. Load a program before Start.
+ */
+AD9833Sequence :: AD9833Sequence ( AD9833 &gen ) : gen(gen) {
+	program = NULL;
+	pc = 0;
+	waitLeft = 0;
+	running = false;
+	waited = false;
+}
+
+void AD9833Sequence :: Load ( const uint8_t *program ) {
+	Stop();
+	this->program = program;
+	pc = 0;
+}
+
+void AD9833Sequence :: Start ( void ) {
+	Stop();
+	pc = 0;
+	waitLeft = 0;
+	waited = false;
+	running = program != NULL;
+}
+
+void AD9833Sequence :: Stop ( void ) {
+	running = false;
+}
+
+bool AD9833Sequence :: IsRunning ( void ) {
+	return running;
+}
+
+uint16_t AD9833Sequence :: GetPosition ( void ) {
+	return pc;
+}
+
+/*
+ * Run opcodes until a wait. Only byte reads from flash and the SPI
+ * writes; the words are sent as they are stored.
+ */
+uint32_t AD9833Sequence :: Tick ( void ) {
+	if ( !running ) return 0;
+	if ( waitLeft != 0 ) return NextWait();	// Rest of a long wait
+
+	uint16_t at = pc;
+	for ( ;; ) {
+		uint8_t op = pgm_read_byte(&program[at++]);
+
+		if ( (op & 0xF8) == SEQ_WRITE_OP ) {
+			uint16_t words[SEQ_WRITE_MAX];
+			uint8_t count = (op & 0x07) + 1;
+			for ( uint8_t i = 0; i < count; i++, at += 2 )
+				words[i] = ((uint16_t)pgm_read_byte(&program[at]) << 8) |
+					pgm_read_byte(&program[at + 1]);
+			gen.SendWords(words,count);
+			gen.shadowValid = 0;		// The chip no longer matches gen
+			continue;
+		}
+
+		uint32_t wait = 0;
+		switch ( op ) {
+			case SEQ_WAIT32:
+				wait = (uint32_t)pgm_read_byte(&program[at++]) << 24;
+				wait |= (uint32_t)pgm_read_byte(&program[at++]) << 16;
+				// Fall through
+			case SEQ_WAIT16:
+				wait |= (uint32_t)pgm_read_byte(&program[at++]) << 8;
+				// Fall through
+			case SEQ_WAIT8:
+				wait |= pgm_read_byte(&program[at++]);
+				if ( wait == 0 ) continue;
+				pc = at;
+				waitLeft = wait;
+				return NextWait();
+
+			case SEQ_REPEAT:
+				if ( waited ) {
+					waited = false;
+					at = 0;
+					continue;
+				}
+				// A loop without a wait would never return
+				// Fall through
+			default:						// SEQ_END
+				pc = at - 1;
+				running = false;
+				return 0;
+		}
+	}
+}
+
+/*
+ * The next piece of the current wait. As in AD9833Burst, the last two
+ * pieces share what is left, so no piece is too short for the Tick
+ * interrupt to keep up with.
+ */
+uint32_t AD9833Sequence :: NextWait ( void ) {
+	uint32_t wait = waitLeft;
+	if ( wait > SEQUENCE_MAX_WAIT )
+		wait = wait >= 2 * SEQUENCE_MAX_WAIT ? SEQUENCE_MAX_WAIT : wait / 2;
+	waitLeft -= wait;
+	waited = true;
+	return wait;
+}
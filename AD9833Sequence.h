@@ -0,0 +1,136 @@
+/*
+ * AD9833Sequence.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * Precompiled command sequences: register words that are already
+ * encoded, with timed waits between them, in a byte array in PROGMEM.
+ * The player only copies words out to SPI, so there is no float math
+ * and no encoding at run time.
+ *
+ * Format, one opcode byte followed by its arguments:
+ *	SEQ_WRITE(n)	n = 1 - 8 words, MSB first, sent in one FSYNC frame
+ *	SEQ_WAIT8		wait 1 byte of microseconds
+ *	SEQ_WAIT16		wait 2 bytes of microseconds, MSB first
+ *	SEQ_WAIT32		wait 4 bytes of microseconds, MSB first
+ *	SEQ_REPEAT		start again at the first opcode
+ *	SEQ_END			stop
+ *
+ * Sequences are normally made from a readable script by the host
+ * compiler in extras/host (seqc), but can be written by hand:
+ *
+ *	const uint8_t beep[] PROGMEM = {
+ *		SEQ_WRITE(3), SEQ_WORD(0x2100), SEQ_WORD(0x69F1), SEQ_WORD(0x4000),
+ *		SEQ_WRITE(1), SEQ_WORD(0x2000),		// 1 kHz sine on
+ *		SEQ_WAIT_US(250000),
+ *		SEQ_WRITE(1), SEQ_WORD(0x2100),
+ *		SEQ_END
+ *	};
+ */
+
+#ifndef __AD9833_SEQUENCE__
+
+#define __AD9833_SEQUENCE__
+
+#include "AD9833.h"
+
+#define SEQ_END				0x00
+#define SEQ_REPEAT			0x01
+#define SEQ_WAIT8			0x02
+#define SEQ_WAIT16			0x03
+#define SEQ_WAIT32			0x04
+#define SEQ_WRITE_OP		0x10		// Low 3 bits: word count - 1
+#define SEQ_WRITE_MAX		UPDATE_BUFFER_SIZE
+
+#define SEQ_WRITE(n)		(uint8_t)(SEQ_WRITE_OP | ((n) - 1))
+#define SEQ_WORD(w)			(uint8_t)((w) >> 8), (uint8_t)(w)
+#define SEQ_WAIT_US(us)		SEQ_WAIT32, (uint8_t)((uint32_t)(us) >> 24), \
+							(uint8_t)((uint32_t)(us) >> 16), \
+							(uint8_t)((uint32_t)(us) >> 8), (uint8_t)(us)
+
+/*
+ * Longest single timer period (usec): 65536 clocks of AD9833Timer1 with
+ * no prescaler. Longer waits are returned in pieces, so the timer never
+ * has to switch prescaler between Ticks (which would rescale the clocks
+ * it has already counted) and every wait is exact to one CPU clock.
+ */
+#ifndef SEQUENCE_MAX_WAIT
+#ifdef F_CPU
+#define SEQUENCE_MAX_WAIT	(65536UL / (F_CPU / 1000000UL))
+#else
+#define SEQUENCE_MAX_WAIT	4096UL		// 16 MHz
+#endif
+#endif
+
+/*
+ * Plays a sequence from a timer interrupt. Each Tick sends the writes
+ * up to the next wait and returns the wait, which the caller loads as
+ * the time to the next Tick:
+ *
+ *	void SequenceTick ( void ) {
+ *		uint32_t wait = player.Tick();
+ *		if ( wait ) AD9833Timer1::SetPeriod(wait);
+ *		else AD9833Timer1::Stop();
+ *	}
+ *
+ * The writes bypass the AD9833 object's register state, so after a
+ * sequence its next calls write every register again. While playing,
+ * Tick writes from interrupt context; leave the other AD9833 functions
+ * alone until the sequence has ended or Stop has been called.
+ */
+class AD9833Sequence {
+
+public:
+
+	AD9833Sequence ( AD9833 &gen );
+
+	// Use 'program' (in PROGMEM) and rewind to its start
+	void Load ( const uint8_t *program );
+
+	// Rewind and play from the next Tick
+	void Start ( void );
+
+	// Stop playing. The AD9833 keeps its current settings.
+	void Stop ( void );
+
+	// Send the writes up to the next wait. Returns the microseconds to
+	// the next Tick, or 0 once the sequence has ended. Waits longer than
+	// SEQUENCE_MAX_WAIT are returned in pieces, none shorter than half
+	// of SEQUENCE_MAX_WAIT.
+	uint32_t Tick ( void );
+
+	// True from Start until SEQ_END or Stop
+	bool IsRunning ( void );
+
+	// Offset of the next opcode
+	uint16_t GetPosition ( void );
+
+private:
+
+	uint32_t		NextWait ( void );
+
+	AD9833			&gen;
+	const uint8_t	*program;
+	volatile uint16_t	pc;
+	volatile uint32_t	waitLeft;
+	volatile bool	running;
+	bool			waited;			// A wait since the last SEQ_REPEAT
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * AD9833SoftSPI.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * Bit-banged SPI transport, for boards whose hardware SPI is taken by
+ * something else (an SD card, a radio). Any three pins will do:
+ *
+ *	AD9833SoftSPI<11,13,10> bus;			// SDATA, SCLK, FSYNC
+ *	AD9833 gen(bus);
+ *
+ * The pins are template parameters, so on AVR every pin write is a
+ * single sbi / cbi on its port (digitalWriteFast2 / digitalWriteFastBit)
+ * and each word is shifted out by a fully unrolled loop: about 8 cycles
+ * a bit, or 2 MHz SCLK on a 16 MHz board, against roughly 100 kHz for
+ * the same loop with digitalWrite. On other boards digitalWriteFast.h
+ * maps the pin writes to digitalWrite, so it works at about that speed.
+ *
+ * On the Mega, pins on ports H to L are above the sbi / cbi range and
+ * are written read-modify-write; do not change other pins of the same
+ * port from an interrupt while a word is being sent.
+ */
+
+#ifndef __AD9833_SOFT_SPI__
+
+#define __AD9833_SOFT_SPI__
+
+#include "AD9833Transport.h"
+#include "digitalWriteFast.h"
+
+#ifndef AD9833_ALWAYS_INLINE
+#define AD9833_ALWAYS_INLINE	inline __attribute__((always_inline))
+#endif
+
+template <uint8_t DataPin, uint8_t ClockPin, uint8_t FsyncPin>
+class AD9833SoftSPI : public AD9833Transport {
+
+public:
+
+	void Begin ( void ) {
+		digitalWriteFast2(FsyncPin,HIGH);
+		digitalWriteFast2(ClockPin,HIGH);		// SPI mode 2: SCLK idles HIGH
+		pinModeFast2(FsyncPin,OUTPUT);
+		pinModeFast2(ClockPin,OUTPUT);
+		pinModeFast2(DataPin,OUTPUT);
+	}
+
+	bool Write ( const uint16_t *words, uint8_t count ) {
+		digitalWriteFast2(FsyncPin,LOW);
+		while ( count-- ) {
+			uint16_t word = *words++;
+			ShiftByte(highByte(word));			// MSB first
+			ShiftByte(lowByte(word));
+		}
+		digitalWriteFast2(FsyncPin,HIGH);
+		return true;
+	}
+
+private:
+
+	// The AD9833 reads SDATA on the falling edge of SCLK
+	static AD9833_ALWAYS_INLINE void ShiftBit ( uint8_t data, uint8_t mask ) {
+		digitalWriteFastBit(DataPin,data & mask);
+		digitalWriteFast2(ClockPin,LOW);
+		digitalWriteFast2(ClockPin,HIGH);
+	}
+
+	// Byte at a time: testing a bit of a byte is one instruction on AVR
+	static AD9833_ALWAYS_INLINE void ShiftByte ( uint8_t data ) {
+		ShiftBit(data,0x80);
+		ShiftBit(data,0x40);
+		ShiftBit(data,0x20);
+		ShiftBit(data,0x10);
+		ShiftBit(data,0x08);
+		ShiftBit(data,0x04);
+		ShiftBit(data,0x02);
+		ShiftBit(data,0x01);
+	}
+};
+
+#endif
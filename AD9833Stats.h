@@ -0,0 +1,201 @@
+/*
+ * AD9833Stats.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * Optional instrumentation, enabled by defining AD9833_INSTRUMENT in
+ * AD9833.h. The AD9833 class then keeps one AD9833Stats, shared by all
+ * devices so the RAM it takes does not grow with the channel count
+ * (see GetStats), with:
+ *	- SPI words written, per register
+ *	- writes skipped because the chip already held the value, per register
+ *	- SPI transactions
+ *	- a latency histogram per public method, in CPU cycles. Bucket n
+ *	  counts calls that took 2^n to 2^(n+1)-1 cycles. Only the call the
+ *	  sketch made is counted, not the ones it makes inside (ApplySignal
+ *	  is one ApplySignal, not also a SetFrequency and a SetPhase).
+ * Defining AD9833_DEBUG_PIN as well drives that pin HIGH for the length
+ * of every SPI transaction, for lining up with a scope or logic analyzer.
+ *
+ * Without AD9833_INSTRUMENT the AD9833_STATS_* macros are empty and no
+ * code or RAM is used.
+ */
+
+#ifndef __AD9833_STATS__
+
+#define __AD9833_STATS__
+
+#include <Arduino.h>
+
+#ifdef AD9833_DEBUG_PIN
+	#include "digitalWriteFast.h"
+	#define AD9833_DEBUG_PIN_BEGIN()	pinModeFast2(AD9833_DEBUG_PIN,OUTPUT)
+	#define AD9833_DEBUG_PIN_HIGH()		digitalWriteFast2(AD9833_DEBUG_PIN,HIGH)
+	#define AD9833_DEBUG_PIN_LOW()		digitalWriteFast2(AD9833_DEBUG_PIN,LOW)
+#else
+	#define AD9833_DEBUG_PIN_BEGIN()
+	#define AD9833_DEBUG_PIN_HIGH()
+	#define AD9833_DEBUG_PIN_LOW()
+#endif
+
+#ifdef AD9833_INSTRUMENT
+
+#ifndef AD9833_STATS_BUCKETS
+#define AD9833_STATS_BUCKETS	20		// Up to 2^20 cycles and over
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+#endif
+
+// Public methods with a latency histogram. Related methods share one.
+typedef enum {
+	STAT_APPLY_SIGNAL,
+	STAT_RETUNE,
+	STAT_RESET,
+	STAT_SET_FREQUENCY,
+	STAT_INCREMENT_FREQUENCY,
+	STAT_FREQUENCY_WORD,		// Set/IncrementFrequencyWord, SetFrequencyWords
+	STAT_SET_PHASE,
+	STAT_INCREMENT_PHASE,
+	STAT_PHASE_WORD,			// Set/IncrementPhaseWord
+	STAT_CONTROL,				// SetWaveform, SetOutputSource, EnableOutput,
+								// SleepMode, DisableDAC/InternalClock,
+								// WriteControlWord
+	STAT_COMMIT_UPDATE,
+	STAT_METHODS
+} AD9833StatMethod;
+
+typedef enum {
+	STAT_CONTROL_REG, STAT_FREQ0_REG, STAT_FREQ1_REG,
+	STAT_PHASE0_REG, STAT_PHASE1_REG, STAT_REGISTERS
+} AD9833StatRegister;
+
+class AD9833Stats {
+
+public:
+
+	AD9833Stats ( void ) { Clear(); }
+
+	void Clear ( void ) {
+		memset(this,0,sizeof(*this));
+	}
+
+	// Count a word going out on SPI, by the register it writes
+	void CountWord ( uint16_t word ) {
+		wordsWritten[Register(word)]++;
+	}
+
+	// Count a write that was skipped
+	void CountRedundant ( AD9833StatRegister reg ) {
+		redundantWrites[reg]++;
+	}
+
+	// Add one call of 'method' that took 'cycles'
+	void Record ( AD9833StatMethod method, uint32_t cycles ) {
+		uint8_t bucket = 0;
+		while ( (cycles >>= 1) != 0 && bucket < AD9833_STATS_BUCKETS - 1 )
+			bucket++;
+		if ( histogram[method][bucket] != 0xFFFF )
+			histogram[method][bucket]++;
+		calls[method]++;
+	}
+
+	// The register a word writes
+	static AD9833StatRegister Register ( uint16_t word ) {
+		switch ( word & 0xC000 ) {
+			case FREQ0_WRITE_REG:	return STAT_FREQ0_REG;
+			case FREQ1_WRITE_REG:	return STAT_FREQ1_REG;
+			case PHASE_WRITE_CMD:
+				return word & PHASE1_WRITE_REG ? STAT_PHASE1_REG : STAT_PHASE0_REG;
+			default:				return STAT_CONTROL_REG;
+		}
+	}
+
+	// Free running CPU cycle count. Boards without a cycle counter use
+	// micros(), so their histograms have a 4 - 8 usec resolution.
+	static uint32_t Cycles ( void ) {
+#if defined(__x86_64__) || defined(__i386__)
+		return (uint32_t)__rdtsc();
+#elif defined(ESP32) || defined(ESP8266)
+		return ESP.getCycleCount();
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+		// DWT cycle counter, started on first use
+		static bool started = false;
+		if ( !started ) {
+			*(volatile uint32_t *)0xE000EDFC |= 0x01000000UL;	// DEMCR.TRCENA
+			*(volatile uint32_t *)0xE0001000 |= 1;				// DWT_CTRL.CYCCNTENA
+			started = true;
+		}
+		return *(volatile uint32_t *)0xE0001004;				// DWT_CYCCNT
+#else
+		return micros() * clockCyclesPerMicrosecond();
+#endif
+	}
+
+	uint32_t		wordsWritten[STAT_REGISTERS];
+	uint32_t		redundantWrites[STAT_REGISTERS];
+	uint32_t		transactions;
+	uint32_t		calls[STAT_METHODS];
+	uint16_t		histogram[STAT_METHODS][AD9833_STATS_BUCKETS];
+};
+
+/*
+ * Times the rest of the scope it is declared in, unless it is nested in
+ * another one
+ */
+class AD9833StatsScope {
+
+public:
+
+	AD9833StatsScope ( AD9833Stats &stats, AD9833StatMethod method ) :
+		stats(stats), method(method), outer(depth++ == 0),
+		start(AD9833Stats::Cycles()) { }
+
+	~AD9833StatsScope ( void ) {
+		uint32_t cycles = AD9833Stats::Cycles() - start;
+		depth--;
+		if ( outer ) stats.Record(method,cycles);
+	}
+
+private:
+
+	static volatile uint8_t	depth;		// Scopes open. In AD9833.cpp.
+
+	AD9833Stats			&stats;
+	AD9833StatMethod	method;
+	bool				outer;
+	uint32_t			start;
+};
+
+#define AD9833_STATS_TIME(method)		AD9833StatsScope statsScope(stats,method)
+#define AD9833_STATS_WORDS(s,words,count) \
+	do { for ( uint8_t w_ = 0; w_ < (count); w_++ ) (s).CountWord((words)[w_]); \
+		 (s).transactions++; } while ( 0 )
+#define AD9833_STATS_REDUNDANT(reg)		stats.CountRedundant(reg)
+
+#else
+
+#define AD9833_STATS_TIME(method)
+#define AD9833_STATS_WORDS(s,words,count)
+#define AD9833_STATS_REDUNDANT(reg)
+
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * AD9833Sweep.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+#include "AD9833Sweep.h"
+
+#define SWEEP_STOPPED		0
+#define SWEEP_RUNNING		1
+#define SWEEP_HOLD			2
+
+#define SWEEP_FRAC_BITS		32			// Log sweep word fraction bits
+#define SWEEP_SERIES_MAX	0.25		// Log step exponent for the series
+
+/*
+ * Create a sweep engine for one frequency register of an AD9833
+ */
+AD9833Sweep :: AD9833Sweep ( AD9833 &gen, Registers freqReg ) : gen(gen) {
+	this->freqReg = freqReg == REG0 ? REG0 : REG1;
+	state = SWEEP_STOPPED;
+	Setup(1000,1000,2);
+}
+
+/*
+ * Precompute the integer steps for a sweep. This is the only place
+ * float math is used.
+ */
+void AD9833Sweep :: Setup ( float startHz, float stopHz, uint16_t steps,
+		SweepType sweepType, bool repeat ) {
+	Stop();
+	this->sweepType = sweepType;
+	this->repeat = repeat;
+	this->steps = steps < 2 ? 2 : steps;
+	startWord = gen.FrequencyToWord(startHz);
+	stopWord = gen.FrequencyToWord(stopHz);
+	down = stopWord < startWord;
+
+	// Linear: split the span into a whole number of LSBs per step and
+	// a remainder that is spread over the sweep Bresenham style
+	uint32_t span = down ? startWord - stopWord : stopWord - startWord;
+	delta = span / (this->steps - 1);
+	remainder = span % (this->steps - 1);
+
+	// Log: constant ratio between steps. What is kept is ratio - 1, as
+	// a 32 bit multiplier with as many fraction bits as will fit. Its
+	// float has 24 bits of precision relative to ratio - 1, not to the
+	// ratio, so over the whole sweep the error is ln(stop / start) / 2^24
+	// however many steps there are.
+	if ( sweepType == LOG_SWEEP ) {
+		if ( startWord == 0 ) startWord = 1;		// Can't start at 0 Hz
+		if ( stopWord == 0 ) stopWord = 1;
+		float x = log((float)stopWord / (float)startWord) / (this->steps - 1);
+		float growth;							// e^x - 1
+		if ( fabs(x) < SWEEP_SERIES_MAX )		// exp(x) - 1 would cancel
+			growth = x * (1 + x / 2 * (1 + x / 3 * (1 + x / 4 * (1 + x / 5 *
+				(1 + x / 6 * (1 + x / 7))))));
+		else
+			growth = exp(x) - 1;
+		int exponent;
+		float mantissa = frexp(fabs(growth),&exponent);	// 0.5 to 1
+		growthShift = 32 - exponent;
+		stepGrowth = (uint32_t)ldexp(mantissa,32);
+		if ( exponent <= -32 ) {			// Less than 2^-32 a step: none
+			growthShift = 32;
+			stepGrowth = 0;
+		}
+	}
+	step = 0;
+	word = startWord;
+}
+
+/*
+ * Load the start frequency and begin stepping on the next Tick
+ */
+void AD9833Sweep :: Start ( void ) {
+	state = SWEEP_STOPPED;
+	step = 0;
+	word = startWord;
+	wordQ = (uint64_t)startWord << SWEEP_FRAC_BITS;
+	errorTerm = 0;
+	gen.SetFrequencyWord(freqReg,word);
+	state = SWEEP_RUNNING;
+}
+
+/*
+ * Stop stepping. The output keeps the current frequency.
+ */
+void AD9833Sweep :: Stop ( void ) {
+	state = SWEEP_STOPPED;
+}
+
+/*
+ * Pause (true) or resume (false) a running sweep
+ */
+void AD9833Sweep :: Hold ( bool hold ) {
+	if ( hold && state == SWEEP_RUNNING ) state = SWEEP_HOLD;
+	else if ( !hold && state == SWEEP_HOLD ) state = SWEEP_RUNNING;
+}
+
+bool AD9833Sweep :: IsRunning ( void ) {
+	return state != SWEEP_STOPPED;
+}
+
+uint16_t AD9833Sweep :: GetStep ( void ) {
+	return step;
+}
+
+/*
+ * Advance one step. Intended to be called from a timer interrupt, so
+ * there is no float math here.
+ */
+void AD9833Sweep :: Tick ( void ) {
+	if ( state != SWEEP_RUNNING ) return;
+
+	if ( ++step >= steps ) {
+		if ( !repeat ) {			// Sweep done. Stay on stopHz.
+			step = steps - 1;
+			state = SWEEP_STOPPED;
+			return;
+		}
+		step = 0;					// Start over
+		word = startWord;
+		wordQ = (uint64_t)startWord << SWEEP_FRAC_BITS;
+		errorTerm = 0;
+	}
+	else if ( step == steps - 1 )
+		word = stopWord;			// Land exactly on stopHz
+	else if ( sweepType == LINEAR_SWEEP )
+		NextLinear();
+	else
+		NextLog();
+
+	gen.SetFrequencyWord(freqReg,word);
+}
+
+// --------------------- PRIVATE FUNCTIONS --------------------------
+
+void AD9833Sweep :: NextLinear ( void ) {
+	uint32_t inc = delta;
+	errorTerm += remainder;
+	if ( errorTerm >= (uint32_t)(steps - 1) ) {
+		errorTerm -= steps - 1;
+		inc++;
+	}
+	word = down ? word - inc : word + inc;
+}
+
+/*
+ * wordQ += or -= wordQ * stepGrowth / 2^growthShift. The product is 92
+ * bits, so it is made from the two 32 bit halves of wordQ; the result
+ * is below 2^60.
+ */
+void AD9833Sweep :: NextLog ( void ) {
+	uint64_t high = (wordQ >> 32) * stepGrowth;
+	uint64_t low = (wordQ & 0xFFFFFFFFUL) * stepGrowth;
+	uint64_t change;
+	if ( growthShift >= 32 )
+		change = (high + (low >> 32)) >> (growthShift - 32);
+	else
+		change = (high << (32 - growthShift)) + (low >> growthShift);
+	wordQ = down ? wordQ - change : wordQ + change;
+	word = (uint32_t)(wordQ >> SWEEP_FRAC_BITS) & FREQ_WORD_MASK;
+}
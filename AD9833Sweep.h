@@ -0,0 +1,103 @@
+/*
+ * AD9833Sweep.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef __AD9833_SWEEP__
+
+#define __AD9833_SWEEP__
+
+#include "AD9833.h"
+
+typedef enum { LINEAR_SWEEP, LOG_SWEEP } SweepType;
+
+/*
+ * Frequency sweep engine. All the float math is done once in Setup;
+ * each Tick is integer math plus the frequency register write. Call
+ * Tick from a timer interrupt for constant step timing (see
+ * AD9833Timer1.h) or from loop().
+ *
+ * While a sweep is running, Tick writes to the AD9833 from interrupt
+ * context, so leave the other AD9833 functions alone until Stop (or
+ * Hold) has been called.
+ */
+class AD9833Sweep {
+
+public:
+
+	AD9833Sweep ( AD9833 &gen, Registers freqReg = REG0 );
+
+	// Precompute a sweep of 'steps' frequencies (at least 2) from
+	// startHz to stopHz inclusive. A sweep may go up or down. If repeat
+	// is true the sweep starts over after stopHz, otherwise it stops.
+	void Setup ( float startHz, float stopHz, uint16_t steps,
+		SweepType sweepType = LINEAR_SWEEP, bool repeat = true );
+
+	// Load the start frequency and begin stepping on the next Tick
+	void Start ( void );
+
+	// Stop stepping. The output keeps the current frequency.
+	void Stop ( void );
+
+	// Pause (true) or resume (false) a running sweep
+	void Hold ( bool hold );
+
+	// Advance one step. Call from a timer interrupt.
+	void Tick ( void );
+
+	// True while the sweep is running (including on hold)
+	bool IsRunning ( void );
+
+	// Index of the step now being output (0 = startHz)
+	uint16_t GetStep ( void );
+
+private:
+
+	void			NextLinear ( void );
+	void			NextLog ( void );
+
+	AD9833			&gen;
+	Registers		freqReg;
+	SweepType		sweepType;
+	bool			repeat;
+
+	uint32_t		startWord, stopWord;
+	uint16_t		steps;
+
+	// Linear: word advances by delta each step, plus one more LSB each
+	// time the remainder error term overflows, so the last step lands
+	// exactly on stopWord.
+	uint32_t		delta, remainder, errorTerm;
+	bool			down;
+
+	// Log: wordQ is the word with SWEEP_FRAC_BITS fraction bits. Each
+	// step adds (or, down, subtracts) wordQ * stepGrowth / 2^growthShift,
+	// so wordQ is multiplied by the step ratio.
+	uint64_t		wordQ;
+	uint32_t		stepGrowth;
+	uint8_t			growthShift;
+
+	volatile uint32_t	word;
+	volatile uint16_t	step;
+	volatile uint8_t	state;
+};
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * AD9833Timer1.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * Periodic interrupt from AVR Timer1 (CTC mode) for driving the AD9833
+ * engines (AD9833Sweep and friends) with constant step timing.
+ *
+ * This header defines the Timer1 compare interrupt, so include it in
+ * exactly ONE file of a sketch, and not together with another library
+ * that uses Timer1 (Servo, TimerOne, ...). On other boards call the
+ * engine's Tick function from a timer interrupt of your own.
+ */
+
+#ifndef __AD9833_TIMER1__
+
+#define __AD9833_TIMER1__
+
+#if !defined(__AVR__)
+#error "AD9833Timer1.h is for AVR boards. Call Tick() from your own timer interrupt."
+#endif
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+
+typedef void (*AD9833TimerCallback) ( void );
+
+class AD9833Timer1 {
+
+public:
+
+	// Call 'callback' from the Timer1 interrupt every periodMicros
+	// (up to about 4 seconds at 16 MHz)
+	static void Start ( uint32_t periodMicros, AD9833TimerCallback callback ) {
+		Stop();
+		AD9833Timer1::callback = callback;
+		TCCR1A = 0;
+		TCNT1 = 0;
+		SetPeriod(periodMicros);
+		TIMSK1 |= _BV(OCIE1A);
+	}
+
+	// Change the period. From inside the callback, this sets the time
+	// until the following interrupt, since the counter restarts in
+	// hardware on the compare match that raised this one. If the count
+	// is already past the new period, the interrupt comes at once.
+	static void SetPeriod ( uint32_t periodMicros ) {
+		SetPeriodTicks(periodMicros * (F_CPU / 1000000UL));
+	}
+
+	// The same in CPU clocks. Up to 65536 clocks the timer runs with no
+	// prescaler, so the period is exact to one clock. The shortest
+	// period is 2 timer clocks. Changing the prescaler costs up to one
+	// clock of the slower one; keep periods to 65536 clocks (split
+	// longer ones, as AD9833Burst and AD9833Sequence do) to avoid it.
+	static void SetPeriodTicks ( uint32_t ticks ) {
+		static const uint16_t prescalers[] = { 1, 8, 64, 256, 1024 };
+		static const uint8_t shifts[] = { 0, 3, 6, 8, 10 };		// log2
+		uint8_t select = 0;
+		while ( select < 4 && ticks / prescalers[select] > 65536UL )
+			select++;
+		ticks /= prescalers[select];
+		if ( ticks > 65536UL ) ticks = 65536UL;
+		if ( ticks < 2 ) ticks = 2;
+		uint16_t top = ticks - 1;
+		OCR1A = top;			// Not double buffered in CTC mode
+
+		// The count so far was made at the old prescaler: convert it to
+		// the new one, or the time already spent would be scaled too
+		uint8_t was = TCCR1B & 0x07;
+		TCCR1B = _BV(WGM12) | (select + 1);		// CTC, clock / prescaler
+		if ( was != 0 && was != select + 1 ) {
+			uint32_t count = ((uint32_t)TCNT1 << shifts[was - 1]) >> shifts[select];
+			TCNT1 = count > 0xFFFFUL ? 0xFFFF : count;
+		}
+
+		// A count already past the new top would only match after
+		// wrapping at 0xFFFF, up to 4 ms (or 4 s prescaled) late. Put it
+		// just below the top instead: the write blocks the compare for
+		// one timer clock, then the match comes on the next.
+		if ( TCNT1 >= top ) TCNT1 = top - 1;
+	}
+
+	static void Stop ( void ) {
+		TIMSK1 &= ~_BV(OCIE1A);
+		TCCR1B = 0;
+	}
+
+	static volatile AD9833TimerCallback callback;
+};
+
+volatile AD9833TimerCallback AD9833Timer1::callback = NULL;
+
+ISR(TIMER1_COMPA_vect) {
+	AD9833TimerCallback callback = AD9833Timer1::callback;
+	if ( callback ) callback();
+}
+
+#endif
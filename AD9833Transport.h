@@ -0,0 +1,54 @@
+/*
+ * AD9833Transport.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * By default the AD9833 class clocks its words out with the Arduino SPI
+ * library and frames them with its FNC pin. An AD9833Transport replaces
+ * both: it is given each group of words that must share one FSYNC
+ * frame and owns the FSYNC line. Pass one to the AD9833 constructor.
+ */
+
+#ifndef __AD9833_TRANSPORT__
+
+#define __AD9833_TRANSPORT__
+
+#include <Arduino.h>
+
+class AD9833Transport {
+
+public:
+
+	// Called by AD9833::Begin. Set up the bus with FSYNC HIGH.
+	virtual void Begin ( void ) = 0;
+
+	// Send 1 to UPDATE_BUFFER_SIZE words, MSB first, in one FSYNC frame.
+	// 'words' is reused after the call returns, so a transport that
+	// sends later must copy them. Returns false if the words were
+	// dropped instead.
+	virtual bool Write ( const uint16_t *words, uint8_t count ) = 0;
+
+	// True while words from earlier Writes are still being sent
+	virtual bool Busy ( void ) { return false; }
+
+	// Wait until everything written has been sent
+	void Flush ( void ) { while ( Busy() ) ; }
+};
+
+#endif
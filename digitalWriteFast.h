@@ -1,3 +1,7 @@
+// The port register tables below are for AVR. Other boards get the
+// same macros as plain digitalWrite / pinMode / digitalRead calls.
+#if defined(__AVR__)
+
 #if !defined(digitalPinToPortReg)
 #if !(defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__) || defined(__AVR_ATmega2561__) )
 
@@ -164,3 +168,42 @@ if (__builtin_constant_p(P) && __builtin_constant_p(V)) { \
                 ( bitRead(*digitalPinToPINReg(P), digitalPinToBit(P))) ) : \
                 digitalRead((P))
 #endif
+
+// Constant pin, value known only at run time (a data bit): a port bit
+// set or clear with no call, where digitalWriteFast2 would fall back
+// to digitalWrite.
+#if !defined(digitalWriteFastBit)
+#define digitalWriteFastBit(P, V) \
+if (__builtin_constant_p(P)) { \
+                if (V) bitSet(*digitalPinToPortReg(P), digitalPinToBit(P)); \
+                else bitClear(*digitalPinToPortReg(P), digitalPinToBit(P)); \
+        } else { \
+                digitalWrite((P), (V)); \
+        }
+#endif
+
+#else
+
+#if !defined(digitalWriteFast)
+#define digitalWriteFast(P, V)		digitalWrite((P), (V))
+#endif
+#if !defined(pinModeFast)
+#define pinModeFast(P, V)			pinMode((P), (V))
+#endif
+#if !defined(digitalReadFast)
+#define digitalReadFast(P)			digitalRead((P))
+#endif
+#if !defined(digitalWriteFast2)
+#define digitalWriteFast2(P, V)		digitalWrite((P), (V))
+#endif
+#if !defined(pinModeFast2)
+#define pinModeFast2(P, V)			pinMode((P), (V))
+#endif
+#if !defined(digitalReadFast2)
+#define digitalReadFast2(P)			digitalRead((P))
+#endif
+#if !defined(digitalWriteFastBit)
+#define digitalWriteFastBit(P, V)	digitalWrite((P), (V))
+#endif
+
+#endif
@@ -6,8 +6,8 @@
  * 
  * If you don't have an oscilloscope or spectrum analyzer, I don't quite know how you will
  * verify correct operation for some of the functions.
- * TODO: Add tests where the Arduino itself vereifies AD9833 basic operation.  Frequency of
- * square wave, sine/triangular wave using the A/D inputs (would need a level shifter).
+ * The SelfTest example has the Arduino itself measure the frequency of the square wave.
+ * TODO: Verify the sine/triangular wave using the A/D inputs (would need a level shifter).
  * 
  * This program is free software: you can redistribute it and/or modify it under 
  * the terms of the GNU General Public License as published by the Free Software Foundation,
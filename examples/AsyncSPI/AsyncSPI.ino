@@ -0,0 +1,70 @@
+/*
+ * AsyncSPI.ino
+ * 2018 WLWilliams
+ * 
+ * This sketch sends the AD9833 register writes from the SPI interrupt
+ * (AVR) or by DMA (SAMD21).
+ * ApplySignal returns as soon as the words are queued, and the sketch
+ * is told by a callback when they have all gone out.
+ * 
+ * This program is free software: you can redistribute it and/or modify it under 
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version. 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ * 
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ * 
+ */
+
+#include <AD9833.h>
+#ifdef __AVR__
+#include <AD9833SPIInterrupt.h>     // Include in one file of the sketch
+#else
+#include <AD9833SAMD21DMA.h>        // SAMD21: a DMA channel feeds the SPI port
+#endif
+
+#define FNC_PIN 4           // Can be any digital IO pin
+#define LED_PIN 13          // Lit while words are being sent
+
+#ifdef __AVR__
+AD9833SPIInterrupt bus(FNC_PIN);
+#else
+AD9833SAMD21DMA bus(FNC_PIN);       // SERCOM4: Zero, M0. See the header for MKR.
+#endif
+AD9833 gen(bus);            // Defaults to 25MHz internal reference frequency
+
+volatile bool sent = false;
+
+void SendDone ( void ) {    // Called from the SPI or DMA interrupt
+    sent = true;
+}
+
+void setup() {
+    pinMode(LED_PIN,OUTPUT);
+    bus.SetCallback(SendDone);
+
+    gen.Begin();
+    gen.ApplySignal(SINE_WAVE,REG0,1000);
+    gen.EnableOutput(true);
+}
+
+void loop() {
+    static float frequency = 1000;
+
+    frequency = frequency < 10000 ? frequency + 100 : 1000;
+    sent = false;
+    digitalWrite(LED_PIN,HIGH);
+    gen.ApplySignal(SINE_WAVE,REG0,frequency);   // Returns at once
+
+    // ... free to do other work while the words go out ...
+
+    while ( !sent ) ;
+    digitalWrite(LED_PIN,LOW);
+    delay(100);
+}
@@ -0,0 +1,58 @@
+/*
+ * FSKModulator.ino
+ * 2018 WLWilliams
+ * 
+ * This sketch demonstrates the AD9833Modulator. Characters typed in the
+ * serial monitor are sent as 1200 baud FSK (1200 Hz / 2200 Hz, the Bell
+ * 202 tones). REG0 and REG1 are loaded once; each bit is then a single
+ * control word written from the Timer1 interrupt.
+ * 
+ * This program is free software: you can redistribute it and/or modify it under 
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version. 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ * 
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ * 
+ */
+
+#include <AD9833.h>
+#include <AD9833Modulator.h>
+#include <AD9833Timer1.h>   // AVR only. Include in one file of the sketch.
+
+#define FNC_PIN     4       // Can be any digital IO pin
+#define BAUD_RATE   1200    // Symbols per second
+
+AD9833 gen(FNC_PIN);        // Defaults to 25MHz internal reference frequency
+AD9833Modulator modulator(gen);
+
+void SymbolTick ( void ) {
+    modulator.Tick();
+}
+
+void setup() {
+    Serial.begin(9600);
+
+    gen.Begin();
+    gen.EnableOutput(true);
+    modulator.SetupFSK(SINE_WAVE,1200,2200);
+    modulator.Start();      // After EnableOutput, so the words have RESET off
+    AD9833Timer1::Start(1000000UL / BAUD_RATE,SymbolTick);
+}
+
+void loop() {
+    // Idle with mark tones (1) between characters
+    if ( Serial.available() && modulator.AvailableForWrite() >= 10 ) {
+        modulator.Write(0);                 // Start bit
+        modulator.WriteByte(Serial.read()); // MSB first
+        modulator.Write(1);                 // Stop bit
+    }
+    else if ( modulator.Pending() == 0 )
+        modulator.Write(1);
+}
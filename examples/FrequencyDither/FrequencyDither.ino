@@ -0,0 +1,85 @@
+/*
+ * FrequencyDither.ino
+ * 2018 WLWilliams
+ *
+ * This sketch outputs 1000.0123 Hz, which is between two frequency words
+ * (the resolution is about 0.093 Hz at 25 MHz). AD9833Dither loads the
+ * words either side into REG0 and REG1 and Timer1 switches between them
+ * 10000 times a second, so the average over a second is within 9.3 uHz
+ * of the target. The sidebands this makes are printed.
+ *
+ * Send a number of milli Hz (0 - 999) on the serial monitor to move the
+ * target within the 1000 - 1001 Hz range.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ *
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ *
+ */
+
+#include <AD9833.h>
+#include <AD9833Dither.h>
+#include <AD9833Timer1.h>   // AVR only. Include in one file of the sketch.
+
+#define FNC_PIN     4       // Can be any digital IO pin
+#define TICK_RATE   10000   // FSEL decisions per second
+
+AD9833 gen(FNC_PIN);        // Defaults to 25MHz internal reference frequency
+AD9833Dither dither(gen);
+
+void DitherTick ( void ) {
+    dither.Tick();
+}
+
+void Report ( void ) {
+    Serial.print("Word ");
+    Serial.print(dither.GetWord());
+    Serial.print(" + ");
+    Serial.print(dither.GetFraction());
+    Serial.print(" / 65536: ");
+    Serial.print(gen.GetActualProgrammedFrequency(REG0),4);
+    Serial.print(" Hz + ");
+    Serial.print(dither.GetFrequencyOffset() * 1000.0,4);
+    Serial.println(" mHz");
+    Serial.print("Resolution over 1 s: ");
+    Serial.print(dither.GetEffectiveResolution(TICK_RATE,1.0) * 1e6,2);
+    Serial.print(" uHz. Sidebands: ");
+    Serial.print(dither.GetSpurLevel(TICK_RATE),1);
+    Serial.print(" dBc at +/- ");
+    Serial.print(dither.GetSpurOffset(TICK_RATE),2);
+    Serial.println(" Hz");
+}
+
+void setup() {
+    Serial.begin(9600);
+
+    gen.Begin();
+    gen.EnableOutput(true);
+    dither.Setup(SINE_WAVE,1000,12);    // 1000.012 Hz (and 0.3 uHz)
+    dither.Start();         // After EnableOutput, so the words have RESET off
+    AD9833Timer1::Start(1000000UL / TICK_RATE,DitherTick);
+    Report();
+}
+
+void loop() {
+    if ( Serial.available() ) {
+        long milliHz = Serial.parseInt();
+        if ( milliHz >= 0 && milliHz < 1000 ) {
+            // Setup rewrites the registers, so stop the ticks meanwhile
+            AD9833Timer1::Stop();
+            dither.Setup(SINE_WAVE,1000,milliHz);
+            dither.Start();
+            AD9833Timer1::Start(1000000UL / TICK_RATE,DitherTick);
+            Report();
+        }
+    }
+}
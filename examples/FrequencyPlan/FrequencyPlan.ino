@@ -0,0 +1,50 @@
+/*
+ * FrequencyPlan.ino
+ * 2018 WLWilliams
+ * 
+ * This sketch plays a musical scale from a frequency plan. The register
+ * words for each note are worked out by the compiler and stored in
+ * flash, so each note costs two flash reads and two SPI words.
+ * 
+ * This program is free software: you can redistribute it and/or modify it under 
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version. 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ * 
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ * 
+ */
+
+#include <AD9833.h>
+#include <AD9833FreqPlan.h>
+
+#define FNC_PIN 4           // Can be any digital IO pin
+
+// C major scale, C4 to C5, for REG0 with the default 25 MHz reference
+const AD9833FreqEntry cMajor[] PROGMEM = {
+    AD9833PlanEntry(261.63), AD9833PlanEntry(293.66),
+    AD9833PlanEntry(329.63), AD9833PlanEntry(349.23),
+    AD9833PlanEntry(392.00), AD9833PlanEntry(440.00),
+    AD9833PlanEntry(493.88), AD9833PlanEntry(523.25)
+};
+
+AD9833 gen(FNC_PIN);        // Defaults to 25MHz internal reference frequency
+AD9833FreqPlan scale(gen,cMajor,AD9833_PLAN_SIZE(cMajor));
+
+void setup() {
+    gen.Begin();
+    gen.ApplySignal(SQUARE_WAVE,REG0,261.63);
+    gen.EnableOutput(true);
+}
+
+void loop() {
+    // Play each note for 250 msec, then start over
+    scale.Next();
+    delay(250);
+}
@@ -0,0 +1,55 @@
+/*
+ * FrequencySweep.ino
+ * 2018 WLWilliams
+ * 
+ * This sketch demonstrates the AD9833Sweep engine. The sweep is stepped
+ * from the Timer1 interrupt, so the step timing stays constant and
+ * loop() is free to do other work.
+ * 
+ * This program is free software: you can redistribute it and/or modify it under 
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version. 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ * 
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ * 
+ */
+
+#include <AD9833.h>
+#include <AD9833Sweep.h>
+#include <AD9833Timer1.h>   // AVR only. Include in one file of the sketch.
+
+#define FNC_PIN 4           // Can be any digital IO pin
+#define LED_PIN 13          // I'm alive blinker
+
+AD9833 gen(FNC_PIN);        // Defaults to 25MHz internal reference frequency
+AD9833Sweep sweep(gen,REG0);
+
+void SweepTick ( void ) {
+    sweep.Tick();
+}
+
+void setup() {
+    pinMode(LED_PIN,OUTPUT);
+
+    gen.Begin();
+    gen.ApplySignal(SINE_WAVE,REG0,1000);
+    gen.EnableOutput(true);
+
+    // 1 kHz to 100 kHz in 1000 logarithmic steps, 1 msec per step,
+    // so one sweep takes 1 second and then starts over.
+    sweep.Setup(1000,100000,1000,LOG_SWEEP,true);
+    sweep.Start();
+    AD9833Timer1::Start(1000,SweepTick);
+}
+
+void loop() {
+    // The main loop is not involved in the sweep
+    digitalWrite(LED_PIN,millis() % 1000 > 500);
+}
@@ -0,0 +1,50 @@
+/*
+ * RemoteControl.ino
+ * 2018 WLWilliams
+ *
+ * This sketch lets a PC drive the AD9833 over the USB serial port with the
+ * AD9833Remote binary protocol, at 1 Mbaud. Bytes are taken by the USART
+ * receive interrupt; loop() applies the frames that have arrived. Use
+ * AD9833Client (extras/linux) on the PC:
+ *     AD9833Client board;
+ *     board.Open("/dev/ttyUSB0",1000000);
+ *     board.SetFrequency(REG0,1000.0);
+ *
+ * AD9833RemoteUSART.h owns USART0, so Serial can not be used here.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ *
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ *
+ */
+
+#include <AD9833.h>
+#include <AD9833Remote.h>
+#include <AD9833RemoteUSART.h>  // AVR only. Include in one file of the sketch.
+
+#define FNC_PIN 4           // Can be any digital IO pin
+#define LED_PIN 13          // Lit while frames are being applied
+
+AD9833 gen(FNC_PIN);        // Defaults to 25MHz internal reference frequency
+AD9833Remote remote(gen,AD9833RemoteUSART::Write);
+
+void setup() {
+    pinMode(LED_PIN,OUTPUT);
+
+    gen.BeginAsync();                       // Poll() finishes the power up
+    AD9833RemoteUSART::Begin(remote,1000000);
+}
+
+void loop() {
+    // Keep loop() short: the ring buffer holds REMOTE_BUFFER_SIZE bytes
+    digitalWrite(LED_PIN,remote.Poll() > 0);
+}
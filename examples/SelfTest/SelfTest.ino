@@ -0,0 +1,93 @@
+/*
+ * SelfTest.ino
+ * 2018 WLWilliams
+ *
+ * This sketch has the Arduino check the AD9833 output itself. The square
+ * wave (VOUT swings rail to rail in SQUARE_WAVE mode) is wired to the
+ * Timer1 input capture pin, ICP1: pin 8 on an Uno or Nano, pin 4 on a
+ * Leonardo or Micro. For a few test frequencies it measures the mean
+ * period over 1000 cycles, compares the result with
+ * GetActualProgrammedFrequency() and prints PASS or FAIL. If the
+ * frequencies are all off by about the same amount, the reference clock
+ * is off: the sketch works out its true frequency, has the library use
+ * it from then on, and checks again.
+ *
+ * The result is only as good as the Arduino's own clock. Boards with a
+ * ceramic resonator (the Uno) are only good to about 0.5%; use a board
+ * with a crystal for ppm work.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ *
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ *
+ */
+
+#include <AD9833.h>
+#include <AD9833FreqMeter.h>
+#include <AD9833InputCapture.h> // AVR only. Include in one file of the sketch.
+
+#define FNC_PIN     4       // Can be any digital IO pin (not ICP1)
+#define PERIODS     1000    // Cycles averaged per measurement
+#define TOLERANCE   100e-6  // Pass within 100 ppm
+
+AD9833 gen(FNC_PIN);        // Defaults to 25MHz internal reference frequency
+AD9833FreqMeter meter;      // Timer1 at F_CPU
+
+const float testFrequencies[] = { 1000.0, 5000.0, 20000.0 };
+#define NUM_TESTS (sizeof(testFrequencies) / sizeof(testFrequencies[0]))
+
+// Measure one frequency. Returns its deviation.
+float Test ( float frequency ) {
+    gen.ApplySignal(SQUARE_WAVE,REG0,frequency);
+    delay(10);                              // Let the output settle
+    meter.Start(PERIODS);
+    while ( !meter.Ready() ) ;              // PERIODS cycles
+    float deviation = meter.GetDeviation(gen.GetActualProgrammedFrequency(REG0));
+    Serial.print(gen.GetActualProgrammedFrequency(REG0),3);
+    Serial.print(F(" Hz programmed, "));
+    Serial.print(meter.GetFrequency(),3);
+    Serial.print(F(" Hz measured, "));
+    Serial.print(deviation * 1e6,1);
+    Serial.print(F(" ppm, jitter "));
+    Serial.print(meter.GetJitterTicks());
+    Serial.println(meter.Verify(gen,REG0,TOLERANCE) ? F(" clocks\tPASS") : F(" clocks\tFAIL"));
+    return deviation;
+}
+
+void setup() {
+    Serial.begin(9600);
+    while ( !Serial ) ;
+
+    gen.Begin();
+    gen.EnableOutput(true);
+    AD9833InputCapture::Begin(meter);
+
+    Serial.println(F("Measuring with the nominal reference"));
+    float low = 1, high = -1;
+    for ( uint8_t i = 0; i < NUM_TESTS; i++ ) {
+        float deviation = Test(testFrequencies[i]);
+        if ( deviation < low ) low = deviation;
+        if ( deviation > high ) high = deviation;
+    }
+
+    // Every frequency off by the same ppm: the reference clock is off
+    if ( high - low < 20e-6 && (low > 2e-6 || high < -2e-6) ) {
+        Serial.print(F("Reference clock is "));
+        Serial.print(meter.Calibrate(gen,REG0));
+        Serial.println(F(" Hz. Measuring again with it"));
+        for ( uint8_t i = 0; i < NUM_TESTS; i++ )
+            Test(testFrequencies[i]);
+    }
+}
+
+void loop() {
+}
@@ -0,0 +1,55 @@
+/*
+ * SequencePlayer.ino
+ * 2018 WLWilliams
+ * 
+ * This sketch plays a precompiled test stimulus with AD9833Sequence.
+ * stimulus.h was made from stimulus.seq by the host compiler:
+ *     extras/host/build/seqc stimulus.seq stimulus.h
+ * so the sketch does no frequency or phase math at all. The writes go
+ * out from the Timer1 interrupt, which is reloaded with each wait.
+ * 
+ * This program is free software: you can redistribute it and/or modify it under 
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version. 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ * 
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ * 
+ */
+
+#include <AD9833.h>
+#include <AD9833Sequence.h>
+#include <AD9833Timer1.h>   // AVR only. Include in one file of the sketch.
+#include "stimulus.h"
+
+#define FNC_PIN 4           // Can be any digital IO pin
+#define LED_PIN 13          // I'm alive blinker
+
+AD9833 gen(FNC_PIN);        // Defaults to 25MHz internal reference frequency
+AD9833Sequence player(gen);
+
+void SequenceTick ( void ) {
+    uint32_t wait = player.Tick();
+    if ( wait ) AD9833Timer1::SetPeriod(wait);  // Time to the next Tick
+    else AD9833Timer1::Stop();                  // Sequence ended
+}
+
+void setup() {
+    pinMode(LED_PIN,OUTPUT);
+
+    gen.Begin();
+    player.Load(stimulus);
+    player.Start();
+    AD9833Timer1::Start(10,SequenceTick);       // First Tick right away
+}
+
+void loop() {
+    // The main loop is not involved in playing the sequence
+    digitalWrite(LED_PIN,millis() % 1000 > 500);
+}
@@ -0,0 +1,22 @@
+/*
+ * Generated by seqc from stimulus.seq. Do not edit.
+ * 61 bytes, 13 SPI words, 950000 usec per pass.
+ */
+
+#include <AD9833Sequence.h>
+
+const uint8_t stimulus[] PROGMEM = {
+	SEQ_WRITE(8), SEQ_WORD(0x2100), SEQ_WORD(0x69F1), SEQ_WORD(0x4000), SEQ_WORD(0xBEEA), SEQ_WORD(0x8000), SEQ_WORD(0xC000), SEQ_WORD(0xE800), SEQ_WORD(0x2000),
+	SEQ_WAIT_US(100000),		// 100000 usec
+	SEQ_WRITE(1), SEQ_WORD(0x2C00),
+	SEQ_WAIT_US(100000),		// 100000 usec
+	SEQ_WRITE(1), SEQ_WORD(0x2800),
+	SEQ_WAIT16, 0xC3, 0x50,		// 50000 usec
+	SEQ_WRITE(1), SEQ_WORD(0x2002),
+	SEQ_WAIT_US(100000),		// 100000 usec
+	SEQ_WRITE(1), SEQ_WORD(0x2028),
+	SEQ_WAIT_US(100000),		// 100000 usec
+	SEQ_WRITE(1), SEQ_WORD(0x2128),
+	SEQ_WAIT_US(500000),		// 500000 usec
+	SEQ_REPEAT
+};
@@ -0,0 +1,47 @@
+/*
+ * SoftSPI.ino
+ * 2018 WLWilliams
+ *
+ * This sketch drives the AD9833 from three ordinary IO pins, leaving the
+ * hardware SPI port to an SD card (or anything else) on the usual pins.
+ * AD9833SoftSPI shifts the words out with direct port writes, at about
+ * 2 MHz SCLK on a 16 MHz board.
+ *
+ * Wiring: SDATA to pin 5, SCLK to pin 6, FSYNC to pin 7.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ *
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ *
+ */
+
+#include <AD9833.h>
+#include <AD9833SoftSPI.h>
+
+// The pins must be constants: they are template parameters
+AD9833SoftSPI<5,6,7> bus;   // SDATA, SCLK, FSYNC
+AD9833 gen(bus);            // Defaults to 25MHz internal reference frequency
+
+void setup() {
+    gen.Begin();
+    gen.ApplySignal(SINE_WAVE,REG0,1000);
+    gen.ApplySignal(SINE_WAVE,REG1,1500);
+    gen.EnableOutput(true);
+}
+
+void loop() {
+    // Alternate between the two frequencies twice a second
+    static bool useReg1 = false;
+    delay(250);
+    useReg1 = !useReg1;
+    gen.SetOutputSource(useReg1 ? REG1 : REG0);
+}
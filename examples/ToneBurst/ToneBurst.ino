@@ -0,0 +1,64 @@
+/*
+ * ToneBurst.ino
+ * 2018 WLWilliams
+ *
+ * This sketch sends bursts of 8 cycles of 40 kHz, one every 10 msec, as
+ * for an ultrasonic range finder. Timer1 gates the output with the RESET
+ * bit: each burst starts at phase 0 and ends within half a CPU clock of
+ * its 8th cycle, and loop() does nothing to keep them going.
+ *
+ * A Timer0 (millis) interrupt that is running when an edge is due delays
+ * it by a few microseconds; for the tightest timing turn Timer0's
+ * interrupt off while bursting.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of
+ * the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * This example code is in the public domain.
+ *
+ * Library code found at: https://github.com/Billwilliams1952/AD9833-Library-Arduino
+ *
+ */
+
+#include <AD9833.h>
+#include <AD9833Burst.h>
+#include <AD9833Timer1.h>   // AVR only. Include in one file of the sketch.
+
+#define FNC_PIN     4       // Can be any digital IO pin
+#define LED_PIN     13      // I'm alive blinker
+
+AD9833 gen(FNC_PIN);        // Defaults to 25MHz internal reference frequency
+AD9833Burst burst(gen);
+
+void BurstTick ( void ) {
+    uint32_t wait = burst.Tick();
+    if ( wait ) AD9833Timer1::SetPeriodTicks(wait);     // CPU clocks to the next Tick
+    else AD9833Timer1::Stop();                          // Last burst sent
+}
+
+void setup() {
+    Serial.begin(9600);
+    pinMode(LED_PIN,OUTPUT);
+
+    gen.Begin();
+    burst.Setup(SINE_WAVE,40000,8,10000);   // 8 cycles, every 10000 usec
+    burst.Start();                          // Until Stop
+    AD9833Timer1::Start(10,BurstTick);      // First burst right away
+
+    Serial.print("Burst of ");
+    Serial.print(burst.GetOnTicks());
+    Serial.print(" CPU clocks, ");
+    Serial.print(burst.GetEdgeError() * 1e9,1);
+    Serial.println(" nsec from 8 whole cycles");
+}
+
+void loop() {
+    // The main loop is not involved in sending the bursts
+    digitalWrite(LED_PIN,millis() % 1000 > 500);
+}
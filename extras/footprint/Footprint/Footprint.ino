@@ -0,0 +1,63 @@
+/*
+ * Footprint.ino
+ *
+ * Sketch built by footprint.sh in one configuration after another to
+ * measure the library's flash and RAM. Not meant to be run.
+ *
+ *   FOOTPRINT_CHANNELS     1 or 8 AD9833 objects
+ *   FOOTPRINT_SHARED       the objects share an AD9833Reference
+ *   FOOTPRINT_WORDS        only the word functions (no float math)
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ */
+
+#include <AD9833.h>
+
+#ifndef FOOTPRINT_CHANNELS
+#define FOOTPRINT_CHANNELS 1
+#endif
+
+#ifdef FOOTPRINT_SHARED
+AD9833Reference mclk(25000000UL);
+#define REFERENCE mclk
+#else
+#define REFERENCE 25000000UL
+#endif
+
+AD9833 gens[] = {
+    AD9833(2,REFERENCE),
+#if FOOTPRINT_CHANNELS == 8
+    AD9833(3,REFERENCE), AD9833(4,REFERENCE), AD9833(5,REFERENCE),
+    AD9833(6,REFERENCE), AD9833(7,REFERENCE), AD9833(8,REFERENCE),
+    AD9833(9,REFERENCE),
+#endif
+};
+
+#define CHANNELS (sizeof(gens) / sizeof(gens[0]))
+
+void setup() {
+    for ( uint8_t i = 0; i < CHANNELS; i++ ) {
+        gens[i].Begin();
+#ifdef FOOTPRINT_WORDS
+        gens[i].SetFrequencyWord(REG0,10737UL * (i + 1));     // About 1 kHz steps
+        gens[i].SetPhaseWord(REG0,i << 8);
+        gens[i].SetWaveform(REG0,SINE_WAVE);
+        gens[i].SetOutputSource(REG0);
+#else
+        gens[i].ApplySignal(SINE_WAVE,REG0,1000.0 * (i + 1),REG0,i * 22.5);
+#endif
+        gens[i].EnableOutput(true);
+    }
+}
+
+void loop() {
+    // Something the compiler can not remove
+    uint8_t i = digitalRead(10) ? CHANNELS - 1 : 0;
+#ifdef FOOTPRINT_WORDS
+    gens[i].IncrementFrequencyWord(REG0,1);
+#else
+    gens[i].IncrementFrequency(REG0,0.1);
+#endif
+}
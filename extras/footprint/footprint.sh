@@ -0,0 +1,37 @@
+#!/bin/sh
+#
+# Flash and RAM of the library on a board, for several configurations,
+# from the sizes arduino-cli reports for the Footprint sketch. Needs
+# arduino-cli with the core for the board installed.
+#
+#   extras/footprint/footprint.sh [fqbn]      (default arduino:avr:uno)
+#
+# RAM is the static RAM of the whole sketch (the AD9833 objects are
+# globals); the difference between the 1 and 8 channel rows over 7 is
+# the RAM of one AD9833.
+#
+
+FQBN=${1:-arduino:avr:uno}
+DIR=$(cd "$(dirname "$0")" && pwd)
+LIB=$(cd "$DIR/../.." && pwd)
+
+run () {
+	out=$(arduino-cli compile --fqbn "$FQBN" --library "$LIB" \
+		--build-property "compiler.cpp.extra_flags=$2" "$DIR/Footprint" 2>&1)
+	if [ $? -ne 0 ]; then
+		printf "%-44s build failed\n%s\n" "$1" "$out"
+		return
+	fi
+	flash=$(echo "$out" | sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p')
+	ram=$(echo "$out" | sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p')
+	printf "%-44s %8s %8s\n" "$1" "$flash" "$ram"
+}
+
+echo "$FQBN"
+printf "%-44s %8s %8s\n" "configuration" "flash" "RAM"
+run "1 channel" "-DFOOTPRINT_CHANNELS=1"
+run "8 channels" "-DFOOTPRINT_CHANNELS=8"
+run "8 channels, shared AD9833Reference" "-DFOOTPRINT_CHANNELS=8 -DFOOTPRINT_SHARED"
+run "8 channels, word functions only" "-DFOOTPRINT_CHANNELS=8 -DFOOTPRINT_SHARED -DFOOTPRINT_WORDS"
+run "8 channels, FNC_PIN" "-DFOOTPRINT_CHANNELS=8 -DFNC_PIN=2"
+run "8 channels, AD9833_INSTRUMENT" "-DFOOTPRINT_CHANNELS=8 -DAD9833_INSTRUMENT"
@@ -0,0 +1,71 @@
+/*
+ * Arduino.h
+ *
+ * Host (Linux) stand-in for the parts of the Arduino core used by the
+ * AD9833 library. Pin writes, delays and SPI traffic are recorded by
+ * HostArduino.cpp instead of driving hardware, so the library can be
+ * built and measured on a PC. See HostArduino.h for the recording API.
+ * extras/linux/LinuxArduino.cpp implements the same functions with the
+ * real clock for running on a single board computer.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define HIGH				0x1
+#define LOW					0x0
+
+#define INPUT				0x0
+#define OUTPUT				0x1
+#define INPUT_PULLUP		0x2
+
+#define lowByte(w)			((uint8_t) ((w) & 0xff))
+#define highByte(w)			((uint8_t) ((w) >> 8))
+
+#define bitRead(value, bit)		(((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)		((value) |= (1UL << (bit)))
+#define bitClear(value, bit)	((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) \
+	((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+#define PROGMEM
+#define F(s)				(s)
+#define pgm_read_byte(addr)	(*(const uint8_t *)(addr))
+#define pgm_read_word(addr)	(*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+
+// No port registers on the host. digitalWriteFast.h keeps these.
+#define digitalWriteFast2(P, V)	digitalWrite((P),(V))
+#define pinModeFast2(P, V)		pinMode((P),(V))
+#define digitalWriteFastBit(P, V)	digitalWrite((P),(V))
+
+// The interrupt enable flag is kept so that code which must not wait
+// with interrupts off can be checked. Nothing interrupts on the host.
+extern bool hostInterruptsOn;
+#define noInterrupts()		(hostInterruptsOn = false)
+#define interrupts()		(hostInterruptsOn = true)
+#define ASYNC_INTERRUPTS_ON()	hostInterruptsOn
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+void pinMode ( uint8_t pin, uint8_t mode );
+void digitalWrite ( uint8_t pin, uint8_t val );
+int digitalRead ( uint8_t pin );
+
+void delay ( unsigned long ms );
+void delayMicroseconds ( unsigned int us );
+unsigned long millis ( void );
+unsigned long micros ( void );
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * HostArduino.cpp
+ *
+ * Host (Linux) implementation of the stand-in Arduino core and SPI
+ * library. See HostArduino.h.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "HostArduino.h"
+#include <SPI.h>
+
+HostRecorder Host;
+SPIClass SPI;
+bool hostInterruptsOn = true;
+
+HostRecorder :: HostRecorder ( void ) {
+	memset(pinState,HIGH,sizeof(pinState));
+	memset(pinModes,INPUT,sizeof(pinModes));
+	recording = false;
+	lowOutputs = 0;
+	selectPins = ~0ULL;
+	listener = NULL;
+	nowMicros = 0;
+	softData = softClock = HOST_NUM_PINS;		// Not decoded
+	softPins = 0;
+	Clear();
+}
+
+void HostRecorder :: Clear ( void ) {
+	words = bytes = fsyncEdges = modeChanges = 0;
+	transactions = framingErrors = lastClock = softClocks = 0;
+	partial = 0;
+	partialBytes = 0;
+	softByte = softBits = 0;
+	inTransaction = false;
+	log.clear();
+}
+
+void HostRecorder :: OnPinMode ( uint8_t pin, uint8_t mode ) {
+	if ( pin >= HOST_NUM_PINS ) return;
+	pinModes[pin] = mode;
+	if ( mode == OUTPUT && pinState[pin] == LOW )
+		lowOutputs |= 1ULL << pin;
+	else
+		lowOutputs &= ~(1ULL << pin);
+}
+
+void HostRecorder :: OnPinWrite ( uint8_t pin, uint8_t val ) {
+	if ( pin >= HOST_NUM_PINS ) return;
+	val = val ? HIGH : LOW;
+	if ( pinState[pin] == val ) return;
+	pinState[pin] = val;
+	if ( pinModes[pin] != OUTPUT ) return;
+	if ( pin == softClock && val == LOW ) {
+		softClocks++;
+		softByte = (softByte << 1) | pinState[softData];
+		if ( ++softBits == 8 ) {
+			softBits = 0;
+			OnByte(softByte);
+		}
+	}
+	if ( val == LOW ) lowOutputs |= 1ULL << pin;
+	else lowOutputs &= ~(1ULL << pin);
+	if ( !(selectPins & ~softPins & (1ULL << pin)) ) return;
+
+	fsyncEdges++;
+	// The AD9833 discards a word that is not complete when FSYNC
+	// goes high. Flag it so the benchmark exposes the bug.
+	if ( val == HIGH && (partialBytes != 0 || softBits != 0) ) {
+		framingErrors++;
+		partialBytes = softBits = 0;
+	}
+}
+
+void HostRecorder :: OnByte ( uint8_t data ) {
+	bytes++;
+	uint64_t selected = lowOutputs & selectPins & ~softPins;
+	if ( selected == 0 ) return;		// Nobody is listening
+
+	if ( partialBytes == 0 ) {
+		partial = (uint16_t)data << 8;
+		partialBytes = 1;
+		return;
+	}
+	partial |= data;
+	partialBytes = 0;
+	words++;
+	if ( recording ) {
+		HostWord word = { partial, selected, nowMicros };
+		log.push_back(word);
+	}
+	if ( listener ) listener(partial,selected);
+}
+
+// ------------------------ Arduino core -----------------------------
+
+void pinMode ( uint8_t pin, uint8_t mode ) {
+	Host.OnPinMode(pin,mode);
+}
+
+void digitalWrite ( uint8_t pin, uint8_t val ) {
+	Host.OnPinWrite(pin,val);
+}
+
+int digitalRead ( uint8_t pin ) {
+	return pin < HOST_NUM_PINS ? Host.pinState[pin] : LOW;
+}
+
+void delay ( unsigned long ms ) {
+	Host.AdvanceMicros(ms * 1000UL);
+}
+
+void delayMicroseconds ( unsigned int us ) {
+	Host.AdvanceMicros(us);
+}
+
+unsigned long millis ( void ) {
+	return Host.Micros() / 1000UL;
+}
+
+unsigned long micros ( void ) {
+	return Host.Micros();
+}
+
+// ------------------------ SPI library ------------------------------
+
+void SPIClass :: begin ( void ) { }
+
+void SPIClass :: end ( void ) { }
+
+void SPIClass :: setDataMode ( uint8_t dataMode ) {
+	(void)dataMode;
+	Host.modeChanges++;
+}
+
+void SPIClass :: beginTransaction ( SPISettings settings ) {
+	Host.transactions++;
+	Host.lastClock = settings.clock;
+	Host.inTransaction = true;
+}
+
+void SPIClass :: endTransaction ( void ) {
+	Host.inTransaction = false;
+}
+
+uint8_t SPIClass :: transfer ( uint8_t data ) {
+	Host.OnByte(data);
+	return 0;
+}
+
+uint16_t SPIClass :: transfer16 ( uint16_t data ) {
+	Host.OnByte(highByte(data));
+	Host.OnByte(lowByte(data));
+	return 0;
+}
+
+void SPIClass :: transfer ( void *buf, size_t count ) {
+	uint8_t *data = (uint8_t *)buf;
+	while ( count-- ) {
+		Host.OnByte(*data);
+		*data++ = 0;					// Received data (MISO is not wired)
+	}
+}
@@ -0,0 +1,100 @@
+/*
+ * HostArduino.h
+ *
+ * Recording API for the host stand-in Arduino core. The stand-in keeps a
+ * simulated clock (advanced only by delay/delayMicroseconds or by hand),
+ * the state of every pin, and a log of each 16-bit word clocked out on
+ * SPI together with the chip select lines that were LOW at the time.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef __HOST_ARDUINO_RECORDER_H__
+#define __HOST_ARDUINO_RECORDER_H__
+
+#include <Arduino.h>
+#include <vector>
+
+#define HOST_NUM_PINS		64
+
+typedef struct {
+	uint16_t		value;			// 16-bit word as seen by the chip
+	uint64_t		selectMask;		// Chip select pins LOW during the word
+	unsigned long	atMicros;		// Simulated time of the word
+} HostWord;
+
+typedef void (*HostWordListener) ( uint16_t value, uint64_t selectMask );
+
+class HostRecorder {
+
+public:
+
+	HostRecorder ( void );
+
+	// Clear all counters and the word log. Pin states and the clock
+	// are kept.
+	void Clear ( void );
+
+	// Keep a copy of every word in 'log' (counters are always kept)
+	void Record ( bool enable ) { recording = enable; }
+
+	// Pins that act as chip selects. Defaults to every pin.
+	void SetSelectMask ( uint64_t mask ) { selectPins = mask; }
+
+	// Also decode the bits shifted out on these pins by a bit-banged
+	// SPI (AD9833SoftSPI): SDATA is read when SCLK falls (SPI mode 2).
+	// Pins of HOST_NUM_PINS turn the decoding off.
+	void SetSoftSPI ( uint8_t dataPin, uint8_t clockPin ) {
+		softData = dataPin;
+		softClock = clockPin;
+		softPins = 0;						// These are not chip selects
+		if ( dataPin < HOST_NUM_PINS ) softPins |= 1ULL << dataPin;
+		if ( clockPin < HOST_NUM_PINS ) softPins |= 1ULL << clockPin;
+	}
+
+	// Called for every completed word, e.g. to feed an emulator
+	void SetListener ( HostWordListener listener ) { this->listener = listener; }
+
+	void AdvanceMicros ( unsigned long us ) { nowMicros += us; }
+	unsigned long Micros ( void ) const { return nowMicros; }
+
+	// Counters since the last Clear()
+	uint32_t		words;			// Complete 16-bit words
+	uint32_t		bytes;			// Bytes clocked on the wire
+	uint32_t		fsyncEdges;		// Chip select transitions (both ways)
+	uint32_t		modeChanges;	// SPI.setDataMode calls
+	uint32_t		transactions;	// SPI.beginTransaction calls
+	uint32_t		framingErrors;	// Select released mid-word
+	uint32_t		lastClock;		// SCLK of the last transaction (Hz)
+	uint32_t		softClocks;		// Falling SCLK edges on the soft SPI
+	bool			inTransaction;	// Between beginTransaction and endTransaction
+
+	std::vector<HostWord>	log;
+	uint8_t			pinState[HOST_NUM_PINS];
+	uint8_t			pinModes[HOST_NUM_PINS];
+
+	// Hooks used by the stand-in core and SPI library
+	void			OnPinMode ( uint8_t pin, uint8_t mode );
+	void			OnPinWrite ( uint8_t pin, uint8_t val );
+	void			OnByte ( uint8_t data );
+
+private:
+
+	bool			recording;
+	uint64_t		lowOutputs;		// Output pins currently driven LOW
+	uint64_t		selectPins;
+	uint64_t		softPins;
+	HostWordListener	listener;
+	unsigned long	nowMicros;
+	uint16_t		partial;
+	uint8_t			partialBytes;
+	uint8_t			softData, softClock;
+	uint8_t			softByte, softBits;
+};
+
+extern HostRecorder Host;
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * HostDMA.h
+ *
+ * Simulated DMA engine for AD9833AsyncSPI. StartTransfer only records
+ * the request, like programming a DMA channel; the bytes go out on the
+ * stand-in SPI bus, and the completion interrupt is raised, when the
+ * test calls Service(). Everything the CPU does in between runs while
+ * the "DMA" is in flight.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef __HOST_DMA_H__
+#define __HOST_DMA_H__
+
+#include <AD9833Async.h>
+
+class HostDMA : public AD9833AsyncSPI {
+
+public:
+
+	HostDMA ( uint8_t FNCpin ) : AD9833AsyncSPI(FNCpin) {
+		data = NULL;
+		count = 0;
+		transfersStarted = 0;
+	}
+
+	// True while a transfer has been started and not completed
+	bool Pending ( void ) const { return data != NULL; }
+
+	// Finish the transfer in flight and raise the completion
+	// interrupt. Returns false if there was nothing to do.
+	bool Service ( void ) {
+		if ( data == NULL ) return false;
+		uint8_t bytes[2 * UPDATE_BUFFER_SIZE];
+		memcpy(bytes,data,count);
+		data = NULL;
+		SPI.beginTransaction(SPISettings(AD9833_SPI_CLOCK,MSBFIRST,SPI_MODE2));
+		SPI.transfer(bytes,count);
+		SPI.endTransaction();
+		TransferComplete();
+		return true;
+	}
+
+	// Service until the queue is empty
+	void RunUntilIdle ( void ) {
+		while ( Service() ) ;
+	}
+
+	uint32_t		transfersStarted;
+
+protected:
+
+	void BeginEngine ( void ) {
+		SPI.begin();
+	}
+
+	void StartTransfer ( const uint8_t *data, uint8_t count ) {
+		this->data = data;
+		this->count = count;
+		transfersStarted++;
+	}
+
+private:
+
+	const uint8_t	*data;
+	uint8_t			count;
+};
+
+#endif
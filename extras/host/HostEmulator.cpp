@@ -0,0 +1,192 @@
+/*
+ * HostEmulator.cpp
+ *
+ * Bit level model of an AD9833. See HostEmulator.h.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "HostEmulator.h"
+#include <AD9833.h>
+#include <math.h>
+
+// Control register bits not named in AD9833.h
+#define CTRL_OPBITEN		0x0020		// VOUT is the MSB, not the DAC
+#define CTRL_DIV2			0x0008		// MSB, rather than MSB / 2
+#define CTRL_MODE			0x0002		// Triangle, rather than sine
+
+#define ACC_MASK			0x1FFFFFFFUL	// 28 bits plus the MSB / 2 bit
+
+#define EMU_LANES			8
+
+// Eight 32-bit lanes. GCC / clang map the operators onto SSE2, AVX2 or
+// NEON instructions, whichever the target has.
+typedef uint32_t EmuVector __attribute__((vector_size(EMU_LANES * 4)));
+
+uint16_t		AD9833Emulator :: sineROM[4096];
+AD9833Emulator	*AD9833Emulator :: attached = NULL;
+uint64_t		AD9833Emulator :: attachedMask = 0;
+
+AD9833Emulator :: AD9833Emulator ( uint32_t mclkHz ) : mclkHz(mclkHz) {
+	if ( sineROM[1024] == 0 )
+		for ( uint16_t i = 0; i < 4096; i++ )
+			sineROM[i] = (uint16_t)lrint(511.5 + 511.5 * sin(2.0 * M_PI * i / 4096.0));
+	PowerOn();
+}
+
+void AD9833Emulator :: PowerOn ( void ) {
+	control = RESET_CMD;
+	freq[0] = freq[1] = 0;
+	phase[0] = phase[1] = 0;
+	lsbPending[0] = lsbPending[1] = false;
+	lsbHeld[0] = lsbHeld[1] = 0;
+	acc = 0;
+	cycles = 0;
+	wordsDecoded = 0;
+	freqUpdates = 0;
+}
+
+void AD9833Emulator :: Attach ( uint8_t fsyncPin ) {
+	attached = this;
+	attachedMask = 1ULL << fsyncPin;
+	Host.SetListener(Listener);
+}
+
+void AD9833Emulator :: Detach ( void ) {
+	if ( attached != this ) return;
+	attached = NULL;
+	Host.SetListener(NULL);
+}
+
+void AD9833Emulator :: Listener ( uint16_t value, uint64_t selectMask ) {
+	if ( attached && (selectMask & attachedMask) )
+		attached->Write(value);
+}
+
+void AD9833Emulator :: Write ( uint16_t word ) {
+	uint16_t data = word & 0x3FFF;
+	wordsDecoded++;
+
+	switch ( word & 0xC000 ) {
+		case 0x0000:						// Control
+			control = data;
+			if ( !(control & B28_CMD) )
+				lsbPending[0] = lsbPending[1] = false;
+			if ( control & RESET_CMD ) acc = 0;
+			break;
+
+		case FREQ0_WRITE_REG:
+		case FREQ1_WRITE_REG: {
+			uint8_t reg = (word & 0xC000) == FREQ0_WRITE_REG ? 0 : 1;
+			uint32_t old = freq[reg];
+			if ( control & B28_CMD ) {
+				// Consecutive writes: LSB then MSB, loaded together
+				if ( !lsbPending[reg] ) {
+					lsbHeld[reg] = data;
+					lsbPending[reg] = true;
+					break;
+				}
+				freq[reg] = ((uint32_t)data << 14) | lsbHeld[reg];
+				lsbPending[reg] = false;
+			}
+			else if ( control & HLB_CMD )
+				freq[reg] = (freq[reg] & 0x3FFF) | ((uint32_t)data << 14);
+			else
+				freq[reg] = (freq[reg] & 0x0FFFC000UL) | data;
+			freqUpdates += freq[reg] != old;
+			break;
+		}
+
+		default:							// PHASE0 / PHASE1
+			phase[(word & PHASE1_WRITE_REG) ? 1 : 0] = word & 0x0FFF;
+			break;
+	}
+}
+
+uint16_t AD9833Emulator :: Triangle ( uint16_t phase12 ) {
+	uint16_t t = (phase12 >> 1) & 0x07FF;		// 11 bits, up then down
+	return t < 1024 ? t : 2047 - t;
+}
+
+double AD9833Emulator :: GetOutputFrequency ( void ) const {
+	return (double)freq[(control & FREQ1_OUTPUT_REG) ? 1 : 0] * mclkHz / pow2_28;
+}
+
+uint16_t AD9833Emulator :: Output ( void ) const {
+	uint32_t p = acc + ((uint32_t)phase[(control & PHASE1_OUTPUT_REG) ? 1 : 0] << 16);
+	if ( control & CTRL_OPBITEN ) {
+		uint8_t bit = (control & CTRL_DIV2) ? 27 : 28;
+		return ((p >> bit) & 1) ? EMULATOR_DAC_MAX : 0;
+	}
+	if ( control & DISABLE_DAC ) return 0;
+	uint16_t phase12 = (p >> 16) & 0x0FFF;
+	return (control & CTRL_MODE) ? Triangle(phase12) : Sine(phase12);
+}
+
+/*
+ * The accumulator does not advance while RESET is held or MCLK is
+ * disabled; the output then stays at the value for the held phase.
+ */
+void AD9833Emulator :: Render ( uint16_t *out, uint32_t count, uint32_t stride ) {
+	bool running = !(control & (RESET_CMD | DISABLE_INT_CLK));
+	uint32_t step = running ? freq[(control & FREQ1_OUTPUT_REG) ? 1 : 0] * stride : 0;
+
+	if ( out != NULL ) {
+		uint32_t p = acc + ((uint32_t)phase[(control & PHASE1_OUTPUT_REG) ? 1 : 0] << 16);
+		uint32_t i = 0;
+
+		if ( (control & (CTRL_OPBITEN | DISABLE_DAC)) == DISABLE_DAC || !running ) {
+			uint16_t value = Output();
+			for ( ; i < count; i++ ) out[i] = value;
+		}
+		else {
+			EmuVector lane, base;
+			for ( uint8_t l = 0; l < EMU_LANES; l++ ) {
+				lane[l] = l * step;
+				base[l] = p;
+			}
+			EmuVector v = base + lane;
+			uint32_t blockStep = EMU_LANES * step;
+			uint8_t mode = (control & CTRL_OPBITEN) ? ((control & CTRL_DIV2) ? 2 : 3) :
+				(control & CTRL_MODE) ? 1 : 0;
+
+			for ( ; i + EMU_LANES <= count; i += EMU_LANES, v += blockStep ) {
+				EmuVector s;
+				switch ( mode ) {
+					case 0: {						// Sine ROM lookup
+						EmuVector index = (v >> 16) & 0x0FFF;
+						for ( uint8_t l = 0; l < EMU_LANES; l++ )
+							s[l] = sineROM[index[l]];
+						break;
+					}
+					case 1: {						// Triangle
+						EmuVector t = (v >> 17) & 0x07FF;
+						s = (t ^ (0 - (t >> 10))) & 0x03FF;
+						break;
+					}
+					case 2:							// MSB
+						s = ((v >> 27) & 1) * EMULATOR_DAC_MAX;
+						break;
+					default:						// MSB / 2
+						s = ((v >> 28) & 1) * EMULATOR_DAC_MAX;
+						break;
+				}
+				for ( uint8_t l = 0; l < EMU_LANES; l++ )
+					out[i + l] = (uint16_t)s[l];
+			}
+
+			uint32_t saved = acc;
+			for ( ; i < count; i++ ) {
+				acc = (saved + i * step) & ACC_MASK;
+				out[i] = Output();
+			}
+			acc = saved;
+		}
+	}
+
+	acc = (acc + count * step) & ACC_MASK;
+	cycles += (uint64_t)count * stride;
+}
@@ -0,0 +1,98 @@
+/*
+ * HostEmulator.h
+ *
+ * Bit level model of an AD9833 for host tests. It decodes the 16-bit
+ * words a driver sends (control, FREQ0/1 with B28 / HLB, PHASE0/1,
+ * RESET and the sleep bits) and runs the chip's signal path one MCLK
+ * at a time:
+ *
+ *	28-bit phase accumulator += FREQx
+ *	+ PHASEx << 16, upper 12 bits		-> sine ROM / triangle -> 10-bit DAC
+ *	MSB (OPBITEN, DIV2) or MSB / 2		-> VOUT at 0 or full scale
+ *
+ * Output samples are DAC codes, 0 - 1023. Render() works on blocks of
+ * eight samples with vector operations (SSE2 / AVX2 / NEON, whatever
+ * the compiler targets), fast enough to run seconds of a 25 MHz MCLK.
+ *
+ * The sine ROM contents are not published; it is modelled as the ideal
+ * 10-bit sine of the 12-bit phase. Everything up to the ROM address is
+ * exact.
+ *
+ *	AD9833Emulator chip;
+ *	chip.Attach(FNC_PIN);					// Decode the words sent to pin
+ *	gen.ApplySignal(SINE_WAVE,REG0,1000);
+ *	chip.Render(buffer,25000);				// 1 msec at 25 MHz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef __HOST_EMULATOR_H__
+#define __HOST_EMULATOR_H__
+
+#include "HostArduino.h"
+
+#define EMULATOR_DAC_MAX	1023		// Full scale DAC code
+
+class AD9833Emulator {
+
+public:
+
+	AD9833Emulator ( uint32_t mclkHz = 25000000UL );
+
+	// Power on state: registers cleared, held in RESET
+	void PowerOn ( void );
+
+	// Decode the words sent while FNC pin 'fsyncPin' is LOW (uses the
+	// Host word listener; one emulator may be attached at a time)
+	void Attach ( uint8_t fsyncPin );
+	void Detach ( void );
+
+	// Decode one 16-bit word, as if clocked in with FSYNC LOW
+	void Write ( uint16_t word );
+
+	// Run 'count' output samples, each 'stride' MCLK cycles apart,
+	// into 'out' (NULL just advances the chip)
+	void Render ( uint16_t *out, uint32_t count, uint32_t stride = 1 );
+
+	// Output for the current accumulator, without advancing it
+	uint16_t Output ( void ) const;
+
+	uint32_t GetMCLK ( void ) const { return mclkHz; }
+	uint16_t GetControl ( void ) const { return control; }
+	uint32_t GetFrequencyWord ( uint8_t reg ) const { return freq[reg & 1]; }
+	uint16_t GetPhaseWord ( uint8_t reg ) const { return phase[reg & 1]; }
+	uint32_t GetAccumulator ( void ) const { return acc & 0x0FFFFFFF; }
+	uint64_t GetCycles ( void ) const { return cycles; }
+
+	// Frequency in Hz of the register selected by FSEL
+	double GetOutputFrequency ( void ) const;
+
+	static uint16_t Sine ( uint16_t phase12 ) { return sineROM[phase12 & 0x0FFF]; }
+	static uint16_t Triangle ( uint16_t phase12 );
+
+	uint32_t		wordsDecoded;
+	uint32_t		freqUpdates;		// FREQ0/1 changes that took effect
+
+private:
+
+	static void Listener ( uint16_t value, uint64_t selectMask );
+
+	uint32_t		mclkHz;
+	uint16_t		control;
+	uint32_t		freq[2];			// 28 bits
+	uint16_t		phase[2];			// 12 bits
+	bool			lsbPending[2];		// B28: LSB written, MSB next
+	uint16_t		lsbHeld[2];
+	uint32_t		acc;				// 28 bits, plus bit 28 for MSB / 2
+	uint16_t		held;				// DAC code while MCLK is disabled
+	uint64_t		cycles;
+
+	static uint16_t			sineROM[4096];
+	static AD9833Emulator	*attached;
+	static uint64_t			attachedMask;
+};
+
+#endif
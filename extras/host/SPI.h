@@ -0,0 +1,54 @@
+/*
+ * SPI.h
+ *
+ * Host (Linux) stand-in for the Arduino SPI library. Every byte sent
+ * is handed to the recorder in HostArduino.cpp, which reassembles the
+ * 16-bit words framed by the FNC (FSYNC) line.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef __HOST_SPI_H__
+#define __HOST_SPI_H__
+
+#include <Arduino.h>
+#include <stddef.h>
+
+#define SPI_HAS_TRANSACTION	1
+
+#define SPI_MODE0			0x00
+#define SPI_MODE1			0x04
+#define SPI_MODE2			0x08
+#define SPI_MODE3			0x0C
+
+#define LSBFIRST			0
+#define MSBFIRST			1
+
+class SPISettings {
+public:
+	SPISettings ( uint32_t clock = 4000000UL, uint8_t bitOrder = MSBFIRST,
+				  uint8_t dataMode = SPI_MODE0 )
+		: clock(clock), bitOrder(bitOrder), dataMode(dataMode) { }
+	uint32_t	clock;
+	uint8_t		bitOrder, dataMode;
+};
+
+class SPIClass {
+public:
+	void		begin ( void );
+	void		end ( void );
+	void		setDataMode ( uint8_t dataMode );
+	void		beginTransaction ( SPISettings settings );
+	void		endTransaction ( void );
+	void		usingInterrupt ( uint8_t interruptNumber ) { (void)interruptNumber; }
+	uint8_t		transfer ( uint8_t data );
+	uint16_t	transfer16 ( uint16_t data );
+	void		transfer ( void *buf, size_t count );
+};
+
+extern SPIClass SPI;
+
+#endif
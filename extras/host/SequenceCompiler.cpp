@@ -0,0 +1,282 @@
+/*
+ * SequenceCompiler.cpp
+ *
+ * Stimulus script to AD9833Sequence compiler. See SequenceCompiler.h.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "SequenceCompiler.h"
+#include <AD9833Fast.h>				// Compile time encoders: same words as AD9833
+#include <AD9833Sequence.h>
+#include <math.h>
+#include <sstream>
+#include <algorithm>
+
+#define KNOWN_CONTROL		0x10
+
+SequenceCompiler :: SequenceCompiler ( void ) {
+	errorLine = 0;
+	words = 0;
+	totalMicros = 0;
+}
+
+bool SequenceCompiler :: Compile ( const std::string &script ) {
+	program.clear();
+	error.clear();
+	errorLine = 0;
+	words = 0;
+	totalMicros = 0;
+
+	mclk = 25000000UL;
+	anyFrequency = false;
+	freq[0] = freq[1] = 0;
+	phase[0] = phase[1] = 0;
+	waveform = SINE_WAVE;
+	fsel = psel = 0;
+	reset = true;				// As left by AD9833::Begin
+	dacOff = clockOff = false;
+	known = 0;
+	controlSent = 0;
+	pending.clear();
+	pendingWait = 0;
+	repeated = false;
+
+	std::istringstream lines(script);
+	std::string line;
+	while ( std::getline(lines,line) ) {
+		errorLine++;
+		line = line.substr(0,line.find('#'));
+		std::transform(line.begin(),line.end(),line.begin(),::tolower);
+		std::istringstream tokens(line);
+		std::vector<std::string> args;
+		std::string token;
+		while ( tokens >> token ) args.push_back(token);
+		if ( args.empty() ) continue;
+		if ( repeated ) return Fail("nothing may follow 'repeat'");
+		if ( !Command(args) ) return false;
+	}
+
+	Flush();
+	EmitWait();							// A wait at the end, before repeat
+	program.push_back(repeated ? SEQ_REPEAT : SEQ_END);
+	errorLine = 0;
+	return true;
+}
+
+bool SequenceCompiler :: Fail ( const std::string &message ) {
+	error = message;
+	return false;
+}
+
+static bool Number ( const std::string &text, double &value, std::string *unit = NULL ) {
+	char *end;
+	value = strtod(text.c_str(),&end);
+	if ( end == text.c_str() ) return false;
+	if ( unit ) *unit = end;
+	else if ( *end != '\0' ) return false;
+	return true;
+}
+
+static int Register ( const std::string &text ) {
+	if ( text == "reg0" || text == "0" ) return 0;
+	if ( text == "reg1" || text == "1" ) return 1;
+	return -1;
+}
+
+static int OnOff ( const std::string &text ) {
+	if ( text == "on" ) return 1;
+	if ( text == "off" ) return 0;
+	return -1;
+}
+
+bool SequenceCompiler :: Command ( const std::vector<std::string> &args ) {
+	const std::string &cmd = args[0];
+	double value;
+
+	if ( cmd == "mclk" ) {
+		if ( args.size() != 2 || !Number(args[1],value) || value < 1 || value > 25e6 )
+			return Fail("usage: mclk <Hz, up to 25000000>");
+		if ( anyFrequency ) return Fail("mclk must come before the first frequency");
+		mclk = (uint32_t)value;
+	}
+	else if ( cmd == "freq0" || cmd == "freq1" ) {
+		if ( args.size() != 2 || !Number(args[1],value) )
+			return Fail("usage: " + cmd + " <Hz>");
+		if ( value < 0 || value > mclk / 2.0 )
+			return Fail("frequency out of range (0 to mclk / 2)");
+		uint8_t reg = cmd[4] - '0';
+		uint32_t word = AD9833FrequencyWord((float)value,mclk);
+		anyFrequency = true;
+		if ( (known & (1 << reg)) && freq[reg] == word ) return true;
+		if ( !(known & KNOWN_CONTROL) ) {
+			// B28 must be set before a two word frequency write
+			Queue(Control());
+			controlSent = Control();
+			known |= KNOWN_CONTROL;
+		}
+		Queue(AD9833FreqLSB(word,reg ? REG1 : REG0));
+		Queue(AD9833FreqMSB(word,reg ? REG1 : REG0));
+		freq[reg] = word;
+		known |= 1 << reg;
+	}
+	else if ( cmd == "phase0" || cmd == "phase1" ) {
+		if ( args.size() != 2 || !Number(args[1],value) )
+			return Fail("usage: " + cmd + " <degrees>");
+		uint8_t reg = cmd[5] - '0';
+		value = fmod(value,360.0);
+		if ( value < 0 ) value += 360.0;
+		uint16_t word = AD9833PhaseWord((float)value);
+		if ( (known & (4 << reg)) && phase[reg] == word ) return true;
+		Queue(AD9833PhaseWrite(word,reg ? REG1 : REG0));
+		phase[reg] = word;
+		known |= 4 << reg;
+	}
+	else if ( cmd == "waveform" ) {
+		static const char *names[] = { "sine", "triangle", "square", "half_square" };
+		static const uint16_t types[] = { SINE_WAVE, TRIANGLE_WAVE, SQUARE_WAVE,
+			HALF_SQUARE_WAVE };
+		uint8_t i = 0;
+		while ( i < 4 && (args.size() != 2 || args[1] != names[i]) ) i++;
+		if ( i == 4 ) return Fail("usage: waveform sine|triangle|square|half_square");
+		waveform = types[i];
+	}
+	else if ( cmd == "output" ) {
+		int f = args.size() >= 2 ? Register(args[1]) : -1;
+		int p = args.size() == 3 ? Register(args[2]) : f;
+		if ( f < 0 || p < 0 || args.size() > 3 )
+			return Fail("usage: output reg0|reg1 [reg0|reg1]");
+		fsel = f ? FREQ1_OUTPUT_REG : 0;
+		psel = p ? PHASE1_OUTPUT_REG : 0;
+	}
+	else if ( cmd == "enable" || cmd == "reset" ) {
+		if ( args.size() != 1 ) return Fail("usage: " + cmd);
+		reset = cmd == "reset";
+	}
+	else if ( cmd == "dac" || cmd == "clock" ) {
+		int on = args.size() == 2 ? OnOff(args[1]) : -1;
+		if ( on < 0 ) return Fail("usage: " + cmd + " on|off");
+		(cmd == "dac" ? dacOff : clockOff) = !on;
+	}
+	else if ( cmd == "wait" ) {
+		std::string unit;
+		if ( args.size() == 3 ) unit = args[2];
+		if ( args.size() < 2 || args.size() > 3 ||
+				!Number(args[1],value,args.size() == 2 ? &unit : NULL) || value < 0 )
+			return Fail("usage: wait <time>[us|ms|s]");
+		if ( unit == "ms" ) value *= 1e3;
+		else if ( unit == "s" ) value *= 1e6;
+		else if ( unit != "" && unit != "us" ) return Fail("unknown time unit '" + unit + "'");
+		Flush();
+		pendingWait += (uint64_t)llround(value);
+	}
+	else if ( cmd == "repeat" ) {
+		if ( args.size() != 1 ) return Fail("usage: repeat");
+		if ( totalMicros + pendingWait == 0 )
+			return Fail("'repeat' needs a wait in the sequence");
+		repeated = true;
+	}
+	else
+		return Fail("unknown command '" + cmd + "'");
+	return true;
+}
+
+uint16_t SequenceCompiler :: Control ( void ) const {
+	return B28_CMD | waveform | fsel | psel | (reset ? RESET_CMD : 0) |
+		(dacOff ? DISABLE_DAC : 0) | (clockOff ? DISABLE_INT_CLK : 0);
+}
+
+void SequenceCompiler :: Queue ( uint16_t word ) {
+	pending.push_back(word);
+}
+
+/*
+ * End of a group of commands: the control word, if it changed, then
+ * the writes after any wait before them, SEQ_WRITE_MAX words a frame.
+ */
+void SequenceCompiler :: Flush ( void ) {
+	if ( !(known & KNOWN_CONTROL) || Control() != controlSent ) {
+		Queue(Control());
+		controlSent = Control();
+		known |= KNOWN_CONTROL;
+	}
+	if ( pending.empty() ) return;
+	EmitWait();
+	for ( size_t i = 0; i < pending.size(); i += SEQ_WRITE_MAX ) {
+		uint8_t count = std::min(pending.size() - i,(size_t)SEQ_WRITE_MAX);
+		program.push_back(SEQ_WRITE(count));
+		for ( uint8_t w = 0; w < count; w++ ) {
+			program.push_back(pending[i + w] >> 8);
+			program.push_back(pending[i + w] & 0xFF);
+		}
+	}
+	words += pending.size();
+	pending.clear();
+}
+
+/*
+ * Emit pendingWait in the shortest opcodes
+ */
+void SequenceCompiler :: EmitWait ( void ) {
+	uint64_t wait = pendingWait;
+	pendingWait = 0;
+	totalMicros += wait;
+	while ( wait > 0 ) {
+		uint32_t piece = wait > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)wait;
+		wait -= piece;
+		if ( piece <= 0xFF )
+			program.push_back(SEQ_WAIT8);
+		else if ( piece <= 0xFFFF )
+			program.push_back(SEQ_WAIT16);
+		else {
+			program.push_back(SEQ_WAIT32);
+			program.push_back(piece >> 24);
+			program.push_back(piece >> 16);
+		}
+		if ( piece > 0xFF ) program.push_back(piece >> 8);
+		program.push_back(piece);
+	}
+}
+
+/*
+ * One opcode a line, written with the SEQ_ macros
+ */
+void SequenceCompiler :: WriteHeader ( FILE *out, const char *name,
+		const char *source ) const {
+	fprintf(out,"/*\n * Generated by seqc from %s. Do not edit.\n"
+		" * %zu bytes, %u SPI words, %llu usec per pass.\n */\n\n",
+		source,program.size(),words,(unsigned long long)totalMicros);
+	fprintf(out,"#include <AD9833Sequence.h>\n\n");
+	fprintf(out,"const uint8_t %s[] PROGMEM = {\n",name);
+	for ( size_t at = 0; at < program.size(); ) {
+		uint8_t op = program[at++];
+		char text[160], comment[32] = "";
+		int length = 0;
+		if ( (op & 0xF8) == SEQ_WRITE_OP ) {
+			uint8_t count = (op & 0x07) + 1;
+			length = snprintf(text,sizeof(text),"SEQ_WRITE(%u)",count);
+			for ( uint8_t w = 0; w < count; w++, at += 2 )
+				length += snprintf(text + length,sizeof(text) - length,
+					", SEQ_WORD(0x%02X%02X)",program[at],program[at + 1]);
+		}
+		else if ( op >= SEQ_WAIT8 && op <= SEQ_WAIT32 ) {
+			uint8_t bytes = op == SEQ_WAIT8 ? 1 : op == SEQ_WAIT16 ? 2 : 4;
+			uint32_t wait = 0;
+			for ( uint8_t b = 0; b < bytes; b++ ) wait = (wait << 8) | program[at++];
+			if ( bytes == 4 )
+				snprintf(text,sizeof(text),"SEQ_WAIT_US(%lu)",(unsigned long)wait);
+			else if ( bytes == 2 )
+				snprintf(text,sizeof(text),"SEQ_WAIT16, 0x%02X, 0x%02X",wait >> 8,wait & 0xFF);
+			else
+				snprintf(text,sizeof(text),"SEQ_WAIT8, %u",wait);
+			snprintf(comment,sizeof(comment),"\t\t// %lu usec",(unsigned long)wait);
+		}
+		else
+			snprintf(text,sizeof(text),op == SEQ_REPEAT ? "SEQ_REPEAT" : "SEQ_END");
+		fprintf(out,"\t%s%s%s\n",text,at < program.size() ? "," : "",comment);
+	}
+	fprintf(out,"};\n");
+}
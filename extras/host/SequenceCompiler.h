@@ -0,0 +1,87 @@
+/*
+ * SequenceCompiler.h
+ *
+ * Translates a readable stimulus script into the AD9833Sequence byte
+ * format (see AD9833Sequence.h). One command per line, '#' starts a
+ * comment:
+ *
+ *	mclk 25000000			reference frequency (before any freq)
+ *	freq0 1000.5			FREQ0 / FREQ1 in Hz
+ *	freq1 2000
+ *	phase0 90				PHASE0 / PHASE1 in degrees
+ *	phase1 0
+ *	waveform sine			sine, triangle, square, half_square
+ *	output reg1 [reg0]		FSEL and optionally PSEL (default: the same)
+ *	enable / reset			RESET off / on
+ *	dac on|off				DAC power
+ *	clock on|off			internal clock
+ *	wait 250us				us (default), ms or s
+ *	repeat					play again from the top (last command)
+ *
+ * The commands between two waits go out together as one or more
+ * FSYNC frames: register writes first, then a single control word with
+ * the final settings, so a register can be loaded and selected without
+ * a glitch. Writes that would not change the chip are left out.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef __SEQUENCE_COMPILER_H__
+#define __SEQUENCE_COMPILER_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class SequenceCompiler {
+
+public:
+
+	SequenceCompiler ( void );
+
+	// Compile a whole script. On failure returns false, with the line
+	// number and message in errorLine / error.
+	bool Compile ( const std::string &script );
+
+	// Write 'program' as a C header defining const uint8_t name[] PROGMEM
+	void WriteHeader ( FILE *out, const char *name, const char *source ) const;
+
+	std::vector<uint8_t>	program;
+	std::string				error;
+	int						errorLine;
+
+	// Totals of the compiled program (one pass, without repeat)
+	uint32_t				words;
+	uint64_t				totalMicros;
+
+private:
+
+	bool			Command ( const std::vector<std::string> &args );
+	bool			Fail ( const std::string &message );
+	void			Queue ( uint16_t word );
+	void			Flush ( void );
+	void			EmitWait ( void );
+	uint16_t		Control ( void ) const;
+
+	uint32_t		mclk;
+	bool			anyFrequency;
+
+	// What the chip will hold once the pending words are sent;
+	// 'known' bits are clear until a register has been written
+	uint32_t		freq[2];
+	uint16_t		phase[2];
+	uint16_t		waveform, fsel, psel;
+	bool			reset, dacOff, clockOff;
+	uint8_t			known;			// 1, 2: FREQ0/1  4, 8: PHASE0/1  16: control
+	uint16_t		controlSent;
+
+	std::vector<uint16_t>	pending;
+	uint64_t		pendingWait;
+	bool			repeated;
+};
+
+#endif
@@ -0,0 +1,616 @@
+/*
+ * benchmark.cpp
+ *
+ * Host throughput benchmark for the AD9833 library. Each public method
+ * is called in a tight loop against the stand-in SPI layer and the
+ * recorder counts what would have gone out on the bus.
+ *
+ *   ./benchmark [iterations]
+ *
+ * Columns:
+ *   calls/s	host calls per second (CPU cost of the library code)
+ *   words		16-bit SPI words per call
+ *   bytes		bytes on the wire per call
+ *   fsync		FNC (FSYNC) edges per call
+ *   mode		SPI mode / transaction setups per call
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "HostArduino.h"
+#include "HostDMA.h"
+#include <AD9833.h>
+#include <AD9833Sweep.h>
+#include <AD9833Modulator.h>
+#include <AD9833Array.h>
+#include <AD9833Fast.h>
+#include <AD9833FreqPlan.h>
+#include <AD9833Sequence.h>
+#include <AD9833Encoder.h>
+#include <AD9833SoftSPI.h>
+#include <string.h>
+#include <vector>
+
+#define FNC_TEST_PIN		4
+
+typedef void (*BenchFunc) ( AD9833 &gen, uint32_t i );
+
+typedef struct {
+	const char		*name;
+	BenchFunc		func;
+} Benchmark;
+
+static volatile float sink;
+
+static void BenchBegin ( AD9833 &gen, uint32_t ) {
+	gen.Begin();
+}
+
+static void BenchApplySignal ( AD9833 &gen, uint32_t i ) {
+	gen.ApplySignal(i & 1 ? SQUARE_WAVE : SINE_WAVE,
+		i & 2 ? REG1 : REG0, 1000.0 + (i & 1023), SAME_AS_REG0, i % 360);
+}
+
+static void BenchBatchedUpdate ( AD9833 &gen, uint32_t i ) {
+	// Retune both registers and switch over in one SPI transaction
+	gen.BeginUpdate();
+	gen.SetFrequency(REG0,1000.0 + (i & 1023));
+	gen.SetFrequency(REG1,2000.0 + (i & 1023));
+	gen.SetPhase(REG1,i % 360);
+	gen.SetOutputSource(i & 1 ? REG1 : REG0);
+	gen.CommitUpdate();
+}
+
+static void BenchRetune ( AD9833 &gen, uint32_t i ) {
+	gen.Retune(1000.0 + (i & 1023),i % 360);
+}
+
+static void BenchReset ( AD9833 &gen, uint32_t ) {
+	gen.Reset();
+}
+
+static void BenchSetFrequency ( AD9833 &gen, uint32_t i ) {
+	gen.SetFrequency(REG0,1000.0 + (i & 1023));
+}
+
+static void BenchSweepFrequency ( AD9833 &gen, uint32_t i ) {
+	// A fine sweep: 0.1 Hz steps, wrapping every 10000 steps
+	gen.SetFrequency(REG0,1000.0 + (i % 10000) * 0.1);
+}
+
+static void BenchIncrementFrequency ( AD9833 &gen, uint32_t i ) {
+	gen.IncrementFrequency(REG0,(i % 10000) ? 1.0 : -9999.0);
+}
+
+static void BenchSetFrequencyWord ( AD9833 &gen, uint32_t i ) {
+	gen.SetFrequencyWord(REG0,10737 + (i & 1023) * 11);
+}
+
+static void BenchIncrementFrequencyWord ( AD9833 &gen, uint32_t i ) {
+	gen.IncrementFrequencyWord(REG0,(i % 10000) ? 11 : -109989);
+}
+
+static void BenchIncrementPhaseWord ( AD9833 &gen, uint32_t ) {
+	gen.IncrementPhaseWord(REG1,11);
+}
+
+static void BenchSetPhase ( AD9833 &gen, uint32_t i ) {
+	gen.SetPhase(REG1,i % 360);
+}
+
+static void BenchIncrementPhase ( AD9833 &gen, uint32_t ) {
+	gen.IncrementPhase(REG1,1.0);
+}
+
+static void BenchSetWaveform ( AD9833 &gen, uint32_t i ) {
+	gen.SetWaveform(REG0,i & 1 ? TRIANGLE_WAVE : SINE_WAVE);
+}
+
+static void BenchSetOutputSource ( AD9833 &gen, uint32_t i ) {
+	gen.SetOutputSource(i & 1 ? REG1 : REG0);
+}
+
+static void BenchEnableOutput ( AD9833 &gen, uint32_t ) {
+	gen.EnableOutput(true);
+}
+
+static void BenchSleepMode ( AD9833 &gen, uint32_t i ) {
+	gen.SleepMode(i & 1);
+}
+
+static void BenchDisableDAC ( AD9833 &gen, uint32_t i ) {
+	gen.DisableDAC(i & 1);
+}
+
+static void BenchDisableInternalClock ( AD9833 &gen, uint32_t i ) {
+	gen.DisableInternalClock(i & 1);
+}
+
+static void BenchGetActualFrequency ( AD9833 &gen, uint32_t i ) {
+	sink = gen.GetActualProgrammedFrequency(i & 1 ? REG1 : REG0);
+}
+
+static void BenchGetActualPhase ( AD9833 &gen, uint32_t i ) {
+	sink = gen.GetActualProgrammedPhase(i & 1 ? REG1 : REG0);
+}
+
+static void BenchGetResolution ( AD9833 &gen, uint32_t ) {
+	sink = gen.GetResolution();
+}
+
+static void BenchSweepLinear ( AD9833 &gen, uint32_t ) {
+	static AD9833Sweep *sweep;
+	static AD9833 *owner;
+	if ( owner != &gen ) {
+		owner = &gen;
+		delete sweep;
+		sweep = new AD9833Sweep(gen,REG0);
+		sweep->Setup(1000,5000,40001,LINEAR_SWEEP,true);
+		sweep->Start();
+	}
+	sweep->Tick();
+}
+
+static void BenchSweepLog ( AD9833 &gen, uint32_t ) {
+	static AD9833Sweep *sweep;
+	static AD9833 *owner;
+	if ( owner != &gen ) {
+		owner = &gen;
+		delete sweep;
+		sweep = new AD9833Sweep(gen,REG0);
+		sweep->Setup(1000,100000,1000,LOG_SWEEP,true);
+		sweep->Start();
+	}
+	sweep->Tick();
+}
+
+static void BenchModulator ( AD9833 &gen, uint32_t i ) {
+	static AD9833Modulator *modulator;
+	static AD9833 *owner;
+	if ( owner != &gen ) {
+		owner = &gen;
+		delete modulator;
+		modulator = new AD9833Modulator(gen);
+		modulator->SetupFSK(SINE_WAVE,1200,2200);
+		modulator->Start();
+	}
+	// Pseudo random bits, so about half the symbols change the output
+	modulator->Write((uint32_t)(i * 2654435761UL) >> 31);
+	modulator->Tick();
+}
+
+static AD9833Fast<FNC_TEST_PIN + 1> fastGen;
+
+static void BenchFastApplySignal ( AD9833 &, uint32_t i ) {
+	if ( i == 0 ) fastGen.Begin();
+	fastGen.ApplySignal(SINE_WAVE,REG0,1000);
+}
+
+static void BenchFastSetFrequency ( AD9833 &, uint32_t i ) {
+	if ( i == 0 ) fastGen.Begin();
+	fastGen.SetFrequency(REG0,1000.0 + (i & 1023));
+}
+
+// One octave of the equal tempered scale, from A4
+static const AD9833FreqEntry scale[] PROGMEM = {
+	AD9833PlanEntry(440.00), AD9833PlanEntry(466.16), AD9833PlanEntry(493.88),
+	AD9833PlanEntry(523.25), AD9833PlanEntry(554.37), AD9833PlanEntry(587.33),
+	AD9833PlanEntry(622.25), AD9833PlanEntry(659.26), AD9833PlanEntry(698.46),
+	AD9833PlanEntry(739.99), AD9833PlanEntry(783.99), AD9833PlanEntry(830.61)
+};
+
+static const float scaleHz[AD9833_PLAN_SIZE(scale)] = {
+	440.00, 466.16, 493.88, 523.25, 554.37, 587.33,
+	622.25, 659.26, 698.46, 739.99, 783.99, 830.61
+};
+
+static void BenchScaleSetFrequency ( AD9833 &gen, uint32_t i ) {
+	gen.SetFrequency(REG0,scaleHz[i % AD9833_PLAN_SIZE(scale)]);
+}
+
+static void BenchScalePlan ( AD9833 &gen, uint32_t ) {
+	static AD9833FreqPlan *plan;
+	static AD9833 *owner;
+	if ( owner != &gen ) {
+		owner = &gen;
+		delete plan;
+		plan = new AD9833FreqPlan(gen,scale,AD9833_PLAN_SIZE(scale));
+	}
+	plan->Next();
+}
+
+// The BeginUpdate..CommitUpdate retune, precompiled: both registers,
+// PHASE1 and the output select, alternating between two settings
+static const uint8_t retune[] PROGMEM = {
+	SEQ_WRITE(6), SEQ_WORD(0x69F1), SEQ_WORD(0x4000), SEQ_WORD(0x93E3), SEQ_WORD(0x8001),
+		SEQ_WORD(0xC800 | 0x2000), SEQ_WORD(0x2000),
+	SEQ_WAIT8, 1,
+	SEQ_WRITE(6), SEQ_WORD(0x6A1B), SEQ_WORD(0x4000), SEQ_WORD(0x940D), SEQ_WORD(0x8001),
+		SEQ_WORD(0xC900 | 0x2000), SEQ_WORD(0x2C00),
+	SEQ_WAIT8, 1,
+	SEQ_REPEAT
+};
+
+static void BenchSequence ( AD9833 &gen, uint32_t ) {
+	static AD9833Sequence *player;
+	static AD9833 *owner;
+	if ( owner != &gen ) {
+		owner = &gen;
+		delete player;
+		player = new AD9833Sequence(gen);
+		player->Load(retune);
+		player->Start();
+	}
+	player->Tick();
+}
+
+static const Benchmark benchmarks[] = {
+	{ "Begin",							BenchBegin },
+	{ "ApplySignal",					BenchApplySignal },
+	{ "BeginUpdate..CommitUpdate",		BenchBatchedUpdate },
+	{ "AD9833Sequence::Tick (same)",	BenchSequence },
+	{ "Retune",							BenchRetune },
+	{ "Reset",							BenchReset },
+	{ "SetFrequency",					BenchSetFrequency },
+	{ "SetFrequency (0.1 Hz sweep)",	BenchSweepFrequency },
+	{ "IncrementFrequency",				BenchIncrementFrequency },
+	{ "SetFrequencyWord",				BenchSetFrequencyWord },
+	{ "IncrementFrequencyWord",			BenchIncrementFrequencyWord },
+	{ "SetFrequency (12 note scale)",	BenchScaleSetFrequency },
+	{ "AD9833FreqPlan::Next (scale)",	BenchScalePlan },
+	{ "AD9833Sweep::Tick (linear)",		BenchSweepLinear },
+	{ "AD9833Sweep::Tick (log)",		BenchSweepLog },
+	{ "AD9833Modulator (Write+Tick)",	BenchModulator },
+	{ "AD9833Fast::ApplySignal (const)",	BenchFastApplySignal },
+	{ "AD9833Fast::SetFrequency",		BenchFastSetFrequency },
+	{ "SetPhase",						BenchSetPhase },
+	{ "IncrementPhase",					BenchIncrementPhase },
+	{ "IncrementPhaseWord",				BenchIncrementPhaseWord },
+	{ "SetWaveform",					BenchSetWaveform },
+	{ "SetOutputSource",				BenchSetOutputSource },
+	{ "EnableOutput (repeated)",		BenchEnableOutput },
+	{ "SleepMode",						BenchSleepMode },
+	{ "DisableDAC",						BenchDisableDAC },
+	{ "DisableInternalClock",			BenchDisableInternalClock },
+	{ "GetActualProgrammedFrequency",	BenchGetActualFrequency },
+	{ "GetActualProgrammedPhase",		BenchGetActualPhase },
+	{ "GetResolution",					BenchGetResolution },
+};
+
+/*
+ * Print one line of results from the recorder counters
+ */
+static void PrintRow ( const char *name, uint32_t iterations, double seconds ) {
+	double n = iterations;
+	printf("%-30s %12.0f %7.2f %7.2f %7.2f %7.2f\n", name,
+		n / seconds, Host.words / n, Host.bytes / n,
+		Host.fsyncEdges / n, (Host.modeChanges + Host.transactions) / n);
+	if ( Host.framingErrors )
+		printf("  *** %u words cut short by FNC ***\n",Host.framingErrors);
+}
+
+static void RunBenchmark ( const Benchmark &bench, uint32_t iterations ) {
+	AD9833 gen(FNC_TEST_PIN);
+	gen.Begin();
+	gen.EnableOutput(true);
+	Host.Clear();
+
+	std::chrono::steady_clock::time_point start =
+		std::chrono::steady_clock::now();
+	for ( uint32_t i = 0; i < iterations; i++ )
+		bench.func(gen,i);
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+
+	PrintRow(bench.name,iterations,elapsed.count());
+}
+
+/*
+ * Eight AD9833s on one bus, as independent objects and as an
+ * AD9833Array. Each iteration retunes all eight channels, or changes
+ * the waveform of all eight.
+ */
+#define ARRAY_DEVICES		8
+
+static void RunArrayBenchmark ( uint32_t iterations ) {
+	AD9833 *devices[ARRAY_DEVICES];
+	for ( uint8_t d = 0; d < ARRAY_DEVICES; d++ )
+		devices[d] = new AD9833(FNC_TEST_PIN + d);
+	AD9833Array bus(devices,ARRAY_DEVICES);
+	bus.Begin();
+	bus.EnableOutput(true);
+
+	for ( uint8_t test = 0; test < 4; test++ ) {
+		Host.Clear();
+		std::chrono::steady_clock::time_point start =
+			std::chrono::steady_clock::now();
+		for ( uint32_t i = 0; i < iterations; i++ ) {
+			bool batched = test & 1;
+			if ( batched ) bus.BeginUpdate();
+			for ( uint8_t d = 0; d < ARRAY_DEVICES; d++ ) {
+				if ( test < 2 )
+					devices[d]->SetFrequency(REG0,1000.0 * (d + 1) + (i & 1023));
+				else
+					devices[d]->SetWaveform(REG0,i & 1 ? TRIANGLE_WAVE : SINE_WAVE);
+			}
+			if ( batched ) bus.CommitUpdate();
+		}
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - start;
+		static const char *names[] = {
+			"8 x SetFrequency (separate)", "8 x SetFrequency (array)",
+			"8 x SetWaveform (separate)", "8 x SetWaveform (array)" };
+		PrintRow(names[test],iterations,elapsed.count());
+	}
+	for ( uint8_t d = 0; d < ARRAY_DEVICES; d++ )
+		delete devices[d];
+}
+
+static volatile uint32_t dmaCallbacks;
+
+static void DMADone ( void ) {
+	dmaCallbacks++;
+}
+
+/*
+ * ApplySignal through the simulated DMA engine. The call only queues
+ * the frame; the words reach the bus when the "DMA" is serviced.
+ */
+static void RunAsyncBenchmark ( uint32_t iterations ) {
+	HostDMA dma(FNC_TEST_PIN);
+	AD9833 gen(dma);
+	dma.SetCallback(DMADone);
+	gen.Begin();
+	dma.RunUntilIdle();
+	gen.EnableOutput(true);
+	dma.RunUntilIdle();
+
+	Host.Clear();
+	dmaCallbacks = 0;
+	uint32_t wordsAtReturn = 0, busyAtReturn = 0;
+	std::chrono::steady_clock::time_point start =
+		std::chrono::steady_clock::now();
+	for ( uint32_t i = 0; i < iterations; i++ ) {
+		uint32_t before = Host.words;
+		BenchApplySignal(gen,i);
+		wordsAtReturn += Host.words - before;	// Sent by the CPU
+		busyAtReturn += gen.Busy();
+		dma.RunUntilIdle();				// The transfer completes later
+	}
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+	PrintRow("ApplySignal (async DMA)",iterations,elapsed.count());
+	printf("  words sent before ApplySignal returned: %u, still in flight "
+		"at return: %u / %u, callbacks: %u\n",wordsAtReturn,busyAtReturn,
+		iterations,(uint32_t)dmaCallbacks);
+
+	// Several updates queued back to back go out in order, one FSYNC
+	// frame each, with a single callback at the end
+	Host.Clear();
+	Host.Record(true);
+	dmaCallbacks = 0;
+	gen.SetFrequency(REG0,1000);
+	gen.SetPhase(REG0,90);
+	gen.SetFrequency(REG1,2000);
+	bool queued = Host.words == 0 && gen.Busy();
+	dma.RunUntilIdle();
+	printf("  3 queued updates: %s, %u words, %u fsync edges, %u callback(s), "
+		"%u framing errors\n",queued ? "held" : "NOT held",Host.words,
+		Host.fsyncEdges,(uint32_t)dmaCallbacks,Host.framingErrors);
+	Host.Record(false);
+}
+
+/*
+ * ApplySignal through the bit-banged transport. The recorder decodes
+ * the SDATA / SCLK edges, so the words and bytes columns count what the
+ * chip receives; the wire time on a board is set by the pin writes.
+ */
+static void RunSoftSPIBenchmark ( uint32_t iterations ) {
+	AD9833SoftSPI<FNC_TEST_PIN + 1,FNC_TEST_PIN + 2,FNC_TEST_PIN> bus;
+	AD9833 gen(bus);
+	Host.SetSoftSPI(FNC_TEST_PIN + 1,FNC_TEST_PIN + 2);
+	gen.Begin();
+	gen.EnableOutput(true);
+
+	Host.Clear();
+	std::chrono::steady_clock::time_point start =
+		std::chrono::steady_clock::now();
+	for ( uint32_t i = 0; i < iterations; i++ )
+		BenchApplySignal(gen,i);
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+	PrintRow("ApplySignal (soft SPI)",iterations,elapsed.count());
+	printf("  SCLK edges per word: %.2f\n",2.0 * Host.softClocks / Host.words);
+	Host.SetSoftSPI(HOST_NUM_PINS,HOST_NUM_PINS);
+}
+
+/*
+ * Host cycle counter, or nanoseconds where there is none
+ */
+static inline uint64_t Cycles ( void ) {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*
+ * Frequency word encoding as SetFrequency did it before the reciprocal
+ * encoder: a float multiply and divide on every call
+ */
+static uint32_t __attribute__((noinline))
+FloatFrequencyToWord ( float frequency, uint32_t refFrequency ) {
+	return (uint32_t)((frequency * pow2_28) / (float)refFrequency) & FREQ_WORD_MASK;
+}
+
+/*
+ * Compare the cost per call of the float encoder and the reciprocal
+ * one the library uses
+ */
+static void RunEncoderBenchmark ( uint32_t iterations ) {
+	AD9833 gen(FNC_TEST_PIN);
+	volatile uint32_t wordSink;
+
+	uint64_t start = Cycles();
+	for ( uint32_t i = 0; i < iterations; i++ )
+		wordSink = FloatFrequencyToWord(1000.0 + (i & 0xFFFFF) * 0.37,25000000UL);
+	double floatCycles = (double)(Cycles() - start) / iterations;
+
+	start = Cycles();
+	for ( uint32_t i = 0; i < iterations; i++ )
+		wordSink = gen.FrequencyToWord(1000.0 + (i & 0xFFFFF) * 0.37);
+	double fixedCycles = (double)(Cycles() - start) / iterations;
+	(void)wordSink;
+
+	// Exact word for comparison: floor(frequency * 2^28 / refFrequency)
+	uint32_t floatOff = 0, fixedOff = 0, constexprOff = 0;
+	for ( uint32_t i = 0; i < 100000; i++ ) {
+		float frequency = 1000.0 + i * 123.45;
+		// frequency * 2^28 is a whole number below 2^53 here
+		uint32_t exact = (uint64_t)((double)frequency * pow2_28) / 25000000UL;
+		if ( FloatFrequencyToWord(frequency,25000000UL) != exact ) floatOff++;
+		if ( gen.FrequencyToWord(frequency) != exact ) fixedOff++;
+		if ( AD9833FrequencyWord(frequency,25000000UL) != gen.FrequencyToWord(frequency) )
+			constexprOff++;
+	}
+
+	printf("\nFrequency word encoding (%s per call)\n",
+#if defined(__x86_64__) || defined(__i386__)
+		"cycles");
+#else
+		"ns");
+#endif
+	printf("  float  (frequency * 2^28 / ref)   %7.2f   %6u / 100000 words off exact\n",
+		floatCycles,floatOff);
+	printf("  integer reciprocal (library)      %7.2f   %6u / 100000 words off exact\n",
+		fixedCycles,fixedOff);
+	printf("  float minus integer, this host    %7.2f\n",floatCycles - fixedCycles);
+	printf("  AD9833FrequencyWord (constexpr) differs from FrequencyToWord: %u / 100000\n",
+		constexprOff);
+	uint32_t planOff = 0;
+	for ( uint16_t n = 0; n < AD9833_PLAN_SIZE(scale); n++ ) {
+		AD9833FreqEntry e = AD9833FreqPlan::Read(scale,n);
+		if ( (((uint32_t)(e.msb & 0x3FFF) << 14) | (e.lsb & 0x3FFF)) !=
+				gen.FrequencyToWord(scaleHz[n]) )
+			planOff++;
+	}
+	printf("  AD9833PlanEntry differs from FrequencyToWord: %u / %u\n",
+		planOff,(unsigned)AD9833_PLAN_SIZE(scale));
+	// A host FPU divides in a few cycles, so the host times say little
+	// about AVR, where the float path is soft-float. The EncoderTiming
+	// sketch (extras/timing) times both there.
+	printf("  soft-float calls per encode: float path 4 (mul, div, 2 conversions), "
+		"integer path 0\n");
+}
+
+/*
+ * AD9833Encoder on a table of frequencies and phases. For phases, the
+ * vector path against the scalar loop, which must give the same bits
+ */
+static void RunBulkEncoderBenchmark ( void ) {
+	const size_t count = 1 << 16;
+	const int passes = 32;
+	std::vector<float> hz(count), deg(count), errors(count), scalarErrors(count);
+	std::vector<uint16_t> words(2 * count), scalarWords(2 * count);
+	for ( size_t i = 0; i < count; i++ ) {
+		hz[i] = 1000.0f + i * 190.7f;
+		deg[i] = i * 0.0055f;					// 0 - 360 degrees
+	}
+	AD9833Encoder encoder;
+	AD9833 gen(FNC_TEST_PIN);
+
+	uint64_t start = Cycles();
+	for ( int p = 0; p < passes; p++ )
+		encoder.EncodeFrequencies(hz.data(),count,REG0,words.data(),errors.data());
+	double frequencyCycles = (double)(Cycles() - start) / passes / count;
+	uint32_t libraryOff = 0;
+	for ( size_t i = 0; i < count; i++ )
+		libraryOff += (((uint32_t)(words[2 * i + 1] & 0x3FFF) << 14) |
+			(words[2 * i] & 0x3FFF)) != gen.FrequencyToWord(hz[i]);
+
+	printf("\nBulk encoding, AD9833Encoder (%s per value, %u lanes)\n",
+#if defined(__x86_64__) || defined(__i386__)
+		"cycles",
+#else
+		"ns",
+#endif
+		AD9833_ENCODER_LANES);
+	printf("  frequencies  %6.2f  (one at a time), %u / %u differ from FrequencyToWord\n",
+		frequencyCycles,libraryOff,(unsigned)count);
+
+	start = Cycles();
+	for ( int p = 0; p < passes; p++ )
+		encoder.EncodePhasesScalar(deg.data(),count,REG1,scalarWords.data(),
+			scalarErrors.data());
+	double scalarCycles = (double)(Cycles() - start) / passes / count;
+	start = Cycles();
+	for ( int p = 0; p < passes; p++ )
+		encoder.EncodePhases(deg.data(),count,REG1,words.data(),errors.data());
+	double vectorCycles = (double)(Cycles() - start) / passes / count;
+	bool same = memcmp(words.data(),scalarWords.data(),count * 2) == 0 &&
+		memcmp(errors.data(),scalarErrors.data(),count * sizeof(float)) == 0;
+	printf("  phases       scalar %6.2f  vector %6.2f  %s\n",
+		scalarCycles,vectorCycles,same ? "bit identical" : "*** DIFFERENT ***");
+}
+
+/*
+ * Where repeated IncrementFrequency / IncrementPhase steps end up,
+ * compared with adding to a float and re-encoding it each step (as
+ * the library did before the register words were kept)
+ */
+static void RunDriftCheck ( void ) {
+	AD9833 gen(FNC_TEST_PIN);
+	const uint32_t steps = 100000;
+
+	gen.SetFrequency(REG0,1000);
+	float frequency = 1000;
+	for ( uint32_t i = 0; i < steps; i++ ) {
+		gen.IncrementFrequency(REG0,0.1);
+		frequency += 0.1f;
+	}
+	int32_t exact = gen.FrequencyToWord(1000.0 + steps * 0.1);
+	printf("\nDrift after %u x IncrementFrequency(0.1 Hz) from 1 kHz\n",steps);
+	printf("  frequency word     %+d words from exact\n",
+		(int32_t)gen.GetFrequencyWord(REG0) - exact);
+	printf("  float accumulator  %+d words from exact\n",
+		(int32_t)gen.FrequencyToWord(frequency) - exact);
+
+	gen.SetPhase(REG1,0);
+	float phase = 0;
+	for ( uint32_t i = 0; i < steps; i++ ) {
+		gen.IncrementPhase(REG1,0.7);
+		phase = fmod(phase + 0.7f,360);
+	}
+	int32_t exactPhase = (int32_t)(BITS_PER_DEG * fmod(steps * 0.7,360.0));
+	printf("Drift after %u x IncrementPhase(0.7 deg)\n",steps);
+	printf("  phase word         %+d words from exact\n",
+		(int32_t)gen.GetPhaseWord(REG1) - exactPhase);
+	printf("  float accumulator  %+d words from exact\n",
+		((int32_t)(BITS_PER_DEG * phase) & 0x0FFF) - exactPhase);
+}
+
+int main ( int argc, char *argv[] ) {
+	uint32_t iterations = argc > 1 ? strtoul(argv[1],NULL,0) : 1000000UL;
+
+	printf("%-30s %12s %7s %7s %7s %7s\n", "method", "calls/s",
+		"words", "bytes", "fsync", "mode");
+	for ( size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++ )
+		RunBenchmark(benchmarks[b],iterations);
+	RunArrayBenchmark(iterations / 8);
+	RunAsyncBenchmark(iterations);
+	RunSoftSPIBenchmark(iterations);
+	RunEncoderBenchmark(iterations);
+	RunBulkEncoderBenchmark();
+	RunDriftCheck();
+	return 0;
+}
@@ -0,0 +1,771 @@
+/*
+ * emulator_check.cpp
+ *
+ * Drives the AD9833 library into the chip emulator (HostEmulator.h) and
+ * compares the spectrum of the rendered output with what each setting
+ * should produce: harmonic levels of the sine, triangle and square
+ * waves, HALF_SQUARE_WAVE at half the frequency, SetOutputSource
+ * switching registers and the programmed phase. Plays a compiled
+ * AD9833Sequence script into it, checks every step of log sweeps,
+ * checks frequency words against the exact quotient for several MCLKs
+ * and the bulk encoder against SetFrequency / SetPhase, measures the
+ * average frequency and the sidebands of the FSEL dither, times the
+ * edges of tone bursts, decodes the bits of the bit-banged SPI
+ * transport, checks that AD9833Array sends transport devices outside
+ * its SPI transaction, measures and calibrates the output of a chip
+ * with an off frequency MCLK through AD9833FreqMeter, then times
+ * Render().
+ *
+ *   ./emulator_check [seconds of MCLK to time]
+ *
+ * Exits non zero if a check fails.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <complex>
+#include <chrono>
+#include "HostArduino.h"
+#include "HostEmulator.h"
+#include "SequenceCompiler.h"
+#include <AD9833.h>
+#include <AD9833Array.h>
+#include <AD9833Sequence.h>
+#include <AD9833Sweep.h>
+#include <AD9833Fast.h>
+#include <AD9833Encoder.h>
+#include <AD9833SoftSPI.h>
+#include <AD9833Dither.h>
+#include <AD9833Burst.h>
+#include <AD9833FreqMeter.h>
+#include "HostDMA.h"
+#include <string.h>
+#include <vector>
+#include <malloc.h>
+
+#define FNC_TEST_PIN		4
+#define SOFT_DATA_PIN		11
+#define SOFT_CLOCK_PIN		13
+#define SOFT_FSYNC_PIN		10
+#define MCLK_HZ				25000000UL
+#define BLOCK_SAMPLES		2500000UL		// 100 msec, 10 Hz bins
+#define TONE_HZ				10000.0
+
+static uint16_t block[BLOCK_SAMPLES];
+static uint32_t failures;
+
+// Output settings (FSEL frequency word, PSEL phase word) seen after each
+// SPI word, for the glitch checks
+static AD9833Emulator *watched;
+static std::vector<uint64_t> seen;
+
+static uint64_t OutputSetting ( AD9833Emulator &chip ) {
+	uint16_t control = chip.GetControl();
+	return ((uint64_t)chip.GetFrequencyWord((control & FREQ1_OUTPUT_REG) ? 1 : 0) << 16) |
+		chip.GetPhaseWord((control & PHASE1_OUTPUT_REG) ? 1 : 0);
+}
+
+static void Watch ( uint16_t value, uint64_t ) {
+	watched->Write(value);
+	seen.push_back(OutputSetting(*watched));
+}
+
+// Settings the output went through that were neither before nor after
+static uint32_t Intermediates ( uint64_t before, uint64_t after ) {
+	uint32_t count = 0;
+	for ( size_t i = 0; i < seen.size(); i++ )
+		count += seen[i] != before && seen[i] != after &&
+			(i == 0 || seen[i] != seen[i - 1]);
+	return count;
+}
+
+// Transport that counts the writes made inside an SPI library transaction
+class OverlapTransport : public AD9833Transport {
+public:
+	uint32_t	writes = 0, overlapped = 0;
+	void Begin ( void ) { }
+	bool Write ( const uint16_t *, uint8_t ) {
+		writes++;
+		overlapped += Host.inTransaction;
+		return true;
+	}
+};
+
+/*
+ * Single bin DFT of the block at frequencyHz (need not be a whole bin).
+ * The mean is removed first so DC does not leak into low bins.
+ */
+static std::complex<double> Bin ( double frequencyHz ) {
+	double mean = 0;
+	for ( uint32_t n = 0; n < BLOCK_SAMPLES; n++ ) mean += block[n];
+	mean /= BLOCK_SAMPLES;
+
+	std::complex<double> sum = 0, w = 1;
+	std::complex<double> rotate = std::polar(1.0,-2.0 * M_PI * frequencyHz / MCLK_HZ);
+	for ( uint32_t n = 0; n < BLOCK_SAMPLES; n++ ) {
+		sum += (block[n] - mean) * w;
+		w *= rotate;
+		if ( (n & 0xFFFF) == 0 ) w /= std::abs(w);
+	}
+	return sum * (2.0 / BLOCK_SAMPLES);
+}
+
+static double Amplitude ( double frequencyHz ) {
+	return std::abs(Bin(frequencyHz));
+}
+
+static double dBc ( double amplitude, double fundamental ) {
+	return 20.0 * log10(amplitude / fundamental + 1e-12);
+}
+
+static void Check ( const char *name, double measured, double low, double high,
+		const char *units ) {
+	bool pass = measured >= low && measured <= high;
+	printf("%-44s %10.2f %-4s [%8.2f, %8.2f]  %s\n",name,measured,units,low,high,
+		pass ? "pass" : "FAIL");
+	failures += !pass;
+}
+
+/*
+ * Input capture on the chip's square wave: render until 'meter' has
+ * 'periods' periods, passing it the count of a timerHz timer at each
+ * rising edge. The count starts just short of 2^32, so it wraps.
+ */
+static void Measure ( AD9833Emulator &chip, AD9833FreqMeter &meter,
+		uint16_t periods, double timerHz ) {
+	const uint32_t chunk = 250000;
+	uint64_t base = 0;						// MCLK cycle of block[0]
+	bool high = chip.Output() > EMULATOR_DAC_MAX / 2;
+	meter.Start(periods);
+	while ( !meter.Ready() ) {
+		chip.Render(block,chunk);
+		for ( uint32_t n = 0; n < chunk; n++ ) {
+			bool now = block[n] > EMULATOR_DAC_MAX / 2;
+			if ( now && !high )
+				meter.Capture(0xFFFF0000UL +
+					(uint32_t)((base + n) * timerHz / chip.GetMCLK()));
+			high = now;
+		}
+		base += chunk;
+	}
+}
+
+// Render a block and check the harmonics n = 1 .. 5 of fHz against
+// 'golden' levels in dBc (NAN: below floorDB)
+static void CheckSpectrum ( AD9833Emulator &chip, const char *wave, double fHz,
+		double fundamental, const double *golden, double floorDB ) {
+	char name[64];
+	chip.Render(block,BLOCK_SAMPLES);
+	double h1 = Amplitude(fHz);
+	snprintf(name,sizeof(name),"%s fundamental (DAC codes)",wave);
+	Check(name,h1,fundamental * 0.99,fundamental * 1.01,"");
+	for ( uint8_t n = 2; n <= 5; n++ ) {
+		double level = dBc(Amplitude(n * fHz),h1);
+		snprintf(name,sizeof(name),"%s harmonic %u",wave,n);
+		if ( isnan(golden[n - 2]) )
+			Check(name,level,-200,floorDB,"dBc");
+		else
+			Check(name,level,golden[n - 2] - 0.5,golden[n - 2] + 0.5,"dBc");
+	}
+}
+
+int main ( int argc, char *argv[] ) {
+	double seconds = argc > 1 ? atof(argv[1]) : 1.0;
+
+	AD9833 gen(FNC_TEST_PIN,MCLK_HZ);
+	AD9833Emulator chip(MCLK_HZ);
+	chip.Attach(FNC_TEST_PIN);
+	gen.Begin();
+
+	// ---- BeginAsync: settings made while starting go out in one burst ----
+	{
+		AD9833 early(FNC_TEST_PIN,MCLK_HZ);
+		Host.Clear();
+		early.BeginAsync();
+		early.ApplySignal(TRIANGLE_WAVE,REG1,4321.0,REG1,90.0);
+		early.SetFrequency(REG0,TONE_HZ);
+		early.EnableOutput(true);
+		uint32_t polls = 0;
+		while ( !early.Poll() ) {
+			polls++;
+			Host.AdvanceMicros(100);			// The rest of loop()
+		}
+		Check("BeginAsync: Poll() calls before ready",polls,
+			(AD9833_POWERUP_MICROS + AD9833_RESET_MICROS) / 100 - 1,
+			(AD9833_POWERUP_MICROS + AD9833_RESET_MICROS) / 100,"");
+		Check("BeginAsync: SPI transactions (RESET, then burst)",Host.transactions,2,2,"");
+		Check("BeginAsync: words in the burst",Host.words - 1,8,8,"");
+		Check("BeginAsync: chip output frequency",chip.GetOutputFrequency(),
+			4321.0 - 0.1,4321.0 + 0.1,"Hz");
+		Check("BeginAsync: chip FREQ0 word",chip.GetFrequencyWord(0) ==
+			early.GetFrequencyWord(REG0),1,1,"");
+		Check("BeginAsync: chip PHASE1 word",chip.GetPhaseWord(1),1024,1024,"");
+		Check("BeginAsync: chip control (triangle, REG1, running)",chip.GetControl(),
+			0x2002 | FREQ1_OUTPUT_REG | PHASE1_OUTPUT_REG,
+			0x2002 | FREQ1_OUTPUT_REG | PHASE1_OUTPUT_REG,"");
+
+		early.SetStartupDelays(0,0);
+		early.ResetAsync();
+		Check("ResetAsync with no delay: ready at the first Poll",early.Poll(),1,1,"");
+	}
+	gen.Begin();						// 'early' changed the chip behind gen
+
+	// ---- Waveforms: harmonic levels relative to the fundamental ----
+	const double sineGolden[4] = { NAN, NAN, NAN, NAN };
+	const double triangleGolden[4] = { NAN, -20.0 * log10(9), NAN, -20.0 * log10(25) };
+	const double squareGolden[4] = { NAN, -20.0 * log10(3), NAN, -20.0 * log10(5) };
+	const double fullScale = EMULATOR_DAC_MAX / 2.0;
+
+	gen.ApplySignal(SINE_WAVE,REG0,TONE_HZ);
+	gen.EnableOutput(true);
+	double f0 = chip.GetOutputFrequency();
+	Check("FREQ0 word matches GetFrequencyWord",
+		chip.GetFrequencyWord(0) == gen.GetFrequencyWord(REG0),1,1,"");
+	Check("Output frequency vs GetActualProgrammedFrequency",
+		f0 - gen.GetActualProgrammedFrequency(REG0),-0.01,0.01,"Hz");
+	CheckSpectrum(chip,"SINE_WAVE",f0,fullScale,sineGolden,-55);
+
+	gen.SetWaveform(REG0,TRIANGLE_WAVE);
+	CheckSpectrum(chip,"TRIANGLE_WAVE",f0,fullScale * 8 / (M_PI * M_PI),
+		triangleGolden,-55);
+
+	gen.SetWaveform(REG0,SQUARE_WAVE);
+	CheckSpectrum(chip,"SQUARE_WAVE",f0,EMULATOR_DAC_MAX * 2 / M_PI,squareGolden,-55);
+
+	gen.SetWaveform(REG0,HALF_SQUARE_WAVE);
+	chip.Render(block,BLOCK_SAMPLES);
+	double half = Amplitude(f0 / 2);
+	Check("HALF_SQUARE_WAVE fundamental at f / 2",half,
+		EMULATOR_DAC_MAX * 2 / M_PI * 0.99,EMULATOR_DAC_MAX * 2 / M_PI * 1.01,"");
+	Check("HALF_SQUARE_WAVE level at f",dBc(Amplitude(f0),half),-200,-55,"dBc");
+
+	// ---- SetOutputSource moves the output to FREQ1 ----
+	gen.ApplySignal(SINE_WAVE,REG0,TONE_HZ);
+	gen.ApplySignal(SINE_WAVE,REG1,1.5 * TONE_HZ);
+	gen.SetOutputSource(REG0);
+	chip.Render(block,BLOCK_SAMPLES);
+	Check("SetOutputSource(REG0): level at FREQ1",
+		dBc(Amplitude(chip.GetFrequencyWord(1) * (double)MCLK_HZ / pow2_28),fullScale),
+		-200,-55,"dBc");
+	gen.SetOutputSource(REG1);
+	double f1 = chip.GetOutputFrequency();
+	chip.Render(block,BLOCK_SAMPLES);
+	Check("SetOutputSource(REG1): output frequency",f1,
+		1.5 * TONE_HZ - 0.1,1.5 * TONE_HZ + 0.1,"Hz");
+	Check("SetOutputSource(REG1): level at FREQ0",dBc(Amplitude(f0),fullScale),
+		-200,-55,"dBc");
+
+	// ---- Phase: measured against the accumulator at the block start ----
+	gen.ApplySignal(SINE_WAVE,REG0,TONE_HZ,REG1,90.0);
+	uint32_t accStart = chip.GetAccumulator();
+	chip.Render(block,BLOCK_SAMPLES);
+	// PHASE1 adds 90 deg; the bin of a sine lags its phase by 90 deg
+	double expected = 360.0 * accStart / pow2_28;
+	double measured = std::arg(Bin(f0)) * 180.0 / M_PI;
+	Check("PHASE1 = 90 deg (error)",remainder(measured - expected,360.0),
+		-0.5,0.5,"deg");
+	gen.SetPhase(REG1,-1e-6f);			// fmod + 360 rounds to 360.0f
+	Check("SetPhase(-1e-6 deg) wraps to word",gen.GetPhaseWord(REG1),0,0,"");
+	{
+		AD9833Encoder encoder(MCLK_HZ);
+		float tiny = -1e-6f, error;
+		uint16_t word;
+		encoder.EncodePhases(&tiny,1,REG1,&word,&error);
+		Check("Encoder: phase word for -1e-6 deg",word & 0x0FFF,0,0,"");
+		Check("Encoder: its error",error,-1e-6,1e-6,"deg");
+	}
+	gen.SetPhase(REG1,-90.0);
+	Check("SetPhase(-90 deg) word",gen.GetPhaseWord(REG1),3072,3072,"");
+
+	// ---- RESET and the sleep bits ----
+	gen.SetOutputSource(REG0);			// PHASE0 is 0: midscale in RESET
+	gen.EnableOutput(false);
+	chip.Render(block,1000);
+	Check("RESET held: output (midscale)",block[999],511,512,"");
+	gen.EnableOutput(true);
+	gen.DisableDAC(true);
+	chip.Render(block,1000);
+	Check("DisableDAC: output",block[999],0,0,"");
+	gen.DisableDAC(false);
+	gen.DisableInternalClock(true);
+	uint32_t acc = chip.GetAccumulator();
+	chip.Render(block,1000);
+	Check("DisableInternalClock: accumulator moved",
+		(double)chip.GetAccumulator() - acc,0,0,"");
+	gen.DisableInternalClock(false);
+
+	// ---- Render() against one sample at a time ----
+	static const WaveformType waves[4] = { SINE_WAVE, TRIANGLE_WAVE, SQUARE_WAVE,
+		HALF_SQUARE_WAVE };
+	uint32_t mismatches = 0;
+	for ( uint8_t w = 0; w < 4; w++ ) {
+		gen.ApplySignal(waves[w],REG0,123456.7,REG0,33.0);
+		AD9833Emulator single = chip;
+		chip.Render(block,10007,3);
+		for ( uint32_t n = 0; n < 10007; n++ ) {
+			uint16_t sample;
+			single.Render(&sample,1,3);
+			mismatches += sample != block[n];
+		}
+	}
+	Check("Render() vs single samples: mismatches",mismatches,0,0,"");
+
+	// ---- Retune: one step from the old output to the new ----
+	gen.ApplySignal(SINE_WAVE,REG0,TONE_HZ,REG0,0);
+	chip.Detach();
+	watched = &chip;
+	Host.SetListener(Watch);
+	uint64_t before = OutputSetting(chip);
+	seen.clear();
+	gen.BeginUpdate();
+	gen.SetFrequency(REG0,2 * TONE_HZ);
+	gen.SetPhase(REG0,45);
+	gen.CommitUpdate();
+	Check("In place SetFrequency + SetPhase: intermediate outputs",
+		Intermediates(before,OutputSetting(chip)),1,1,"");
+	uint32_t retuneGlitches = 0;
+	for ( uint16_t i = 0; i < 1000; i++ ) {
+		before = OutputSetting(chip);
+		seen.clear();
+		gen.Retune(1000.0 + i * 37.3,i * 7.0);
+		retuneGlitches += Intermediates(before,OutputSetting(chip));
+		retuneGlitches += seen.size() && seen.back() != OutputSetting(chip);
+	}
+	Check("Retune x 1000: intermediate outputs",retuneGlitches,0,0,"");
+	Check("Retune: output frequency",chip.GetOutputFrequency(),
+		1000.0 + 999 * 37.3 - 0.1,1000.0 + 999 * 37.3 + 0.1,"Hz");
+	Check("Retune: GetActiveRegister matches FSEL",
+		gen.GetActiveRegister() == ((chip.GetControl() & FREQ1_OUTPUT_REG) ? REG1 : REG0),
+		1,1,"");
+	chip.Attach(FNC_TEST_PIN);
+
+	// ---- A compiled sequence, one sample per microsecond ----
+	static const char *script =
+		"# Two tones, then a triangle, then off\n"
+		"freq0 1000\nfreq1 5000\nwaveform sine\noutput reg0\nenable\n"
+		"wait 20ms\n"
+		"output reg1\n"
+		"wait 20ms\n"
+		"waveform triangle\n"
+		"wait 10 ms\n"
+		"reset\n"
+		"wait 5000\n"
+		"repeat\n";
+	static const double toneAt[] = { 1000, 5000, 5000, 5000 };
+	static const uint16_t waveAt[] = { SINE_WAVE, SINE_WAVE, TRIANGLE_WAVE, TRIANGLE_WAVE };
+	static const uint32_t waitAt[] = { 20000, 20000, 10000, 5000 };
+	SequenceCompiler compiler;
+	if ( !compiler.Compile(script) ) {
+		printf("script line %d: %s\n",compiler.errorLine,compiler.error.c_str());
+		return 1;
+	}
+	AD9833Sequence player(gen);
+	player.Load(compiler.program.data());
+	player.Start();
+	uint32_t stepErrors = 0, totalWait = 0;
+	uint32_t wordsBefore = chip.wordsDecoded;
+	for ( uint8_t step = 0; step < 8; step++ ) {
+		uint8_t s = step & 3;
+		bool off = s == 3;
+		uint32_t wait = 0;
+		do {									// Long waits come in pieces
+			uint32_t piece = player.Tick();
+			stepErrors += piece == 0 || piece > SEQUENCE_MAX_WAIT;
+			chip.Render(block,piece,MCLK_HZ / 1000000UL);
+			wait += piece;
+		} while ( wait < waitAt[s] );
+		stepErrors += wait != waitAt[s];
+		stepErrors += fabs(chip.GetOutputFrequency() - toneAt[s]) > 0.1;
+		stepErrors += (chip.GetControl() & (0x2000 | 0x0002)) != (waveAt[s] & 0x2002);
+		stepErrors += ((chip.GetControl() & RESET_CMD) != 0) != off;
+		totalWait += wait;
+	}
+	Check("Sequence: steps not as scripted",stepErrors,0,0,"");
+	Check("Sequence: usec per pass",totalWait / 2,55000,55000,"us");
+	Check("Sequence: SPI words for two passes",chip.wordsDecoded - wordsBefore,
+		2 * compiler.words,2 * compiler.words,"");
+	player.Stop();
+
+	// Short and long waits mixed: each is returned in pieces that one
+	// unprescaled Timer1 period can time, none too short, and they add up
+	{
+		SequenceCompiler mixed;
+		mixed.Compile("freq0 1000\nwait 10\nfreq0 2000\nwait 100 ms\n"
+			"freq0 3000\nwait 4097\nfreq0 4000\nwait 8193\nfreq0 5000\n"
+			"wait 20\n");
+		static const uint32_t waits[] = { 10, 100000, 4097, 8193, 20 };
+		AD9833Sequence timed(gen);
+		timed.Load(mixed.program.data());
+		timed.Start();
+		uint32_t wrong = 0, pieces = 0, longest = 0, shortest = 0xFFFFFFFFUL;
+		for ( uint8_t w = 0; w < 5; w++ ) {
+			uint32_t total = 0;
+			do {
+				uint32_t piece = timed.Tick();
+				if ( piece == 0 ) break;
+				if ( waits[w] > SEQUENCE_MAX_WAIT && piece < shortest ) shortest = piece;
+				if ( piece > longest ) longest = piece;
+				total += piece;
+				pieces++;
+			} while ( total < waits[w] );
+			wrong += total != waits[w];
+		}
+		wrong += timed.Tick() != 0;				// Ended
+		Check("Sequence: mixed waits not as scripted",wrong,0,0,"");
+		Check("Sequence: longest piece",longest,0,SEQUENCE_MAX_WAIT,"us");
+		Check("Sequence: shortest piece of a split wait",shortest,
+			SEQUENCE_MAX_WAIT / 2,SEQUENCE_MAX_WAIT,"us");
+		Check("Sequence: pieces for 10 us, 100 ms, 4097, 8193, 20 us",pieces,
+			1 + 25 + 2 + 3 + 1,1 + 25 + 2 + 3 + 1,"");
+		gen.Begin();
+	}
+
+	// ---- Log sweeps: every step against start * (stop / start)^(n / N) ----
+	{
+		const struct { float startHz, stopHz; uint16_t steps; } sweeps[] = {
+			{ 10, 1000, 10000 }, { 20, 20000, 5000 }, { 100000, 100, 1000 },
+			{ 1, 1e6, 3 }
+		};
+		AD9833 swept(FNC_TEST_PIN + 1,MCLK_HZ);		// Not the emulated chip
+		swept.Begin();
+		AD9833Sweep sweep(swept,REG0);
+		for ( uint8_t s = 0; s < sizeof(sweeps) / sizeof(sweeps[0]); s++ ) {
+			sweep.Setup(sweeps[s].startHz,sweeps[s].stopHz,sweeps[s].steps,LOG_SWEEP,false);
+			sweep.Start();
+			double start = swept.GetFrequencyWord(REG0),
+				stop = swept.FrequencyToWord(sweeps[s].stopHz), worst = 0;
+			for ( uint16_t n = 0; n < sweeps[s].steps; n++ ) {
+				// The word is expected truncated: expected - word in [0, 1)
+				double expected = start * pow(stop / start,(double)n / (sweeps[s].steps - 1)),
+					below = expected - swept.GetFrequencyWord(REG0);
+				worst = fmax(worst,fmax(-below,below - 1));
+				sweep.Tick();
+			}
+			char name[64];
+			snprintf(name,sizeof(name),"Log sweep %g-%g Hz / %u, step miss",
+				sweeps[s].startHz,sweeps[s].stopHz,sweeps[s].steps);
+			Check(name,worst,-1,0.05,"LSB");
+		}
+		sweep.Setup(20,20000,5000,LOG_SWEEP,false);
+		sweep.Start();
+		for ( uint16_t n = 0; n < 4998; n++ ) sweep.Tick();
+		Check("Log sweep 20-20000 Hz, step 4998",swept.GetActualProgrammedFrequency(REG0),
+			19971,19973,"Hz");
+	}
+
+	// ---- Frequency words: floor(f * 2^28 / MCLK), for slow clocks too ----
+	{
+		const uint32_t clocks[] = { MCLK_HZ, 16000000UL, 1000000UL, 32768UL };
+		for ( uint8_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++ ) {
+			AD9833Reference reference(clocks[c]);
+			AD9833 coder(FNC_TEST_PIN,reference);
+			uint32_t seed = 7, off = 0, constOff = 0;
+			for ( uint32_t i = 0; i < 100000; i++ ) {
+				seed = seed * 1664525UL + 1013904223UL;
+				// Up to MCLK / 2, with a tenth of them below 1 Hz
+				float hz = (seed >> 8) * (clocks[c] / 2.0f / (1UL << 24));
+				if ( i % 10 == 0 ) hz = ldexpf(hz,-24);
+				// hz * 2^28 is exact in a double; its floor, divided, is exact
+				uint32_t exact = (uint64_t)((double)hz * pow2_28) / clocks[c];
+				off += coder.FrequencyToWord(hz) != exact;
+				constOff += AD9833FrequencyWord(hz,clocks[c]) != exact;
+			}
+			char name[64];
+			snprintf(name,sizeof(name),"Words off exact, %lu Hz MCLK",(unsigned long)clocks[c]);
+			Check(name,off,0,0,"");
+			snprintf(name,sizeof(name),"AD9833FrequencyWord off exact, %lu Hz",
+				(unsigned long)clocks[c]);
+			Check(name,constOff,0,0,"");
+		}
+		AD9833Reference zero(0);
+		Check("Reference of 0 taken as 25 MHz",zero.frequency,25e6,25e6,"Hz");
+	}
+
+	// ---- Bulk encoder: the library's words, vector and scalar phases ----
+	{
+		const size_t count = 100003;			// Not a multiple of the lanes
+		std::vector<float> hz(count), deg(count), errors(count), scalarErrors(count);
+		std::vector<uint16_t> words(2 * count), scalarWords(2 * count);
+		uint32_t seed = 1;
+		for ( size_t i = 0; i < count; i++ ) {
+			seed = seed * 1664525UL + 1013904223UL;
+			hz[i] = (seed >> 8) * (14e6f / (1UL << 24)) - 0.5e6f;	// Some out of range
+			deg[i] = (seed & 0xFFFF) * (800.0f / 65536) - 200.0f;
+		}
+		AD9833Encoder encoder(MCLK_HZ);
+		encoder.EncodeFrequencies(hz.data(),count,REG1,words.data(),errors.data());
+		uint32_t off = 0;
+		double worst = 0;
+		for ( size_t i = 0; i < count; i++ ) {
+			gen.SetFrequency(REG1,hz[i]);
+			uint32_t word = gen.GetFrequencyWord(REG1);
+			off += words[2 * i] != (FREQ1_WRITE_REG | (word & 0x3FFF)) ||
+				words[2 * i + 1] != (FREQ1_WRITE_REG | (word >> 14));
+			if ( hz[i] >= 0 && hz[i] <= 12.5e6f ) {
+				double actual = (double)word * MCLK_HZ / (1UL << 28);
+				worst = fmax(worst,fabs(actual - hz[i] - errors[i]));
+			}
+		}
+		Check("Encoder: frequency words != SetFrequency",off,0,0,"");
+		Check("Encoder: frequency error, worst miss",worst * 1e6,0,1,"uHz");
+
+		encoder.EncodePhases(deg.data(),count,REG0,words.data(),errors.data());
+		encoder.EncodePhasesScalar(deg.data(),count,REG0,scalarWords.data(),
+			scalarErrors.data());
+		Check("Encoder: phase words, vector != scalar",
+			memcmp(words.data(),scalarWords.data(),count * 2) != 0,0,0,"");
+		Check("Encoder: phase errors, vector != scalar",
+			memcmp(errors.data(),scalarErrors.data(),count * sizeof(float)) != 0,0,0,"");
+		off = 0;
+		worst = 0;
+		for ( size_t i = 0; i < count; i += 7 ) {
+			gen.SetPhase(REG0,deg[i]);
+			off += words[i] != (PHASE_WRITE_CMD | gen.GetPhaseWord(REG0));
+			worst = fmax(worst,fabs(errors[i]));
+		}
+		Check("Encoder: phase words != SetPhase",off,0,0,"");
+		Check("Encoder: phase error, largest",worst,0,360.0 / 4096,"deg");
+	}
+
+	// ---- Dither: average frequency between two words, and sidebands ----
+	{
+		AD9833Dither dither(gen);
+		const double resolution = (double)MCLK_HZ / (1UL << 28);
+		dither.Setup(SINE_WAVE,1000,12);		// 1000.012 Hz
+		double target = (dither.GetWord() + dither.GetFraction() / 65536.0) * resolution;
+		Check("Dither: Setup(1000 Hz, 12 mHz) split",(target - 1000.012) * 1e6,
+			-resolution / 65536 * 1e6,resolution / 65536 * 1e6,"uHz");
+
+		// The accumulator after 65536 ticks against the target word
+		const uint32_t tickSamples = MCLK_HZ / 10000;	// 10 kHz ticks
+		const uint32_t ticks = 65536;
+		gen.EnableOutput(true);
+		dither.Start();
+		uint32_t acc0 = chip.GetAccumulator();
+		bool phase0 = true;
+		for ( uint32_t t = 0; t < ticks; t++ ) {
+			dither.Tick();
+			phase0 &= !(chip.GetControl() & PHASE1_OUTPUT_REG);
+			chip.Render(NULL,tickSamples);
+		}
+		uint64_t wanted = (uint64_t)ticks * tickSamples * dither.GetWord() +
+			(uint64_t)tickSamples * dither.GetFraction() * (ticks / 65536);
+		int32_t behind = (int32_t)(((acc0 + wanted - chip.GetAccumulator()) << 4)) >> 4;
+		Check("Dither: phase behind target after 65536 ticks",
+			(double)behind / tickSamples,-1,1,"word");
+		Check("Dither: average frequency error",
+			behind * resolution / ((double)ticks * tickSamples) * 1e6,
+			-resolution / 65536 * 1e6,resolution / 65536 * 1e6,"uHz");
+		Check("Dither: stays on PHASE0",phase0,1,1,"");
+		Check("Dither: resolution, 10 kHz ticks for 1 s",
+			dither.GetEffectiveResolution(10000,1) * 1e6,
+			resolution / 10000 * 1e6 * 0.999,resolution / 10000 * 1e6 * 1.001,"uHz");
+
+		// A quarter word above TONE_HZ, 400 Hz ticks: a sideband each side
+		// 100 Hz out, at no more than the level GetSpurLevel gives
+		const double tickRate = 400;
+		dither.SetupWord(SINE_WAVE,gen.FrequencyToWord(TONE_HZ),0x4000);
+		dither.Start();
+		const uint32_t blockTicks = BLOCK_SAMPLES / (MCLK_HZ / (uint32_t)tickRate);
+		for ( uint32_t t = 0; t < blockTicks; t++ ) {
+			dither.Tick();
+			chip.Render(block + t * (BLOCK_SAMPLES / blockTicks),BLOCK_SAMPLES / blockTicks);
+		}
+		double f = (dither.GetWord() + 0.25) * resolution;
+		double carrier = Amplitude(f);
+		double predicted = dither.GetSpurLevel(tickRate);
+		Check("Dither: sideband offset",dither.GetSpurOffset(tickRate),100,100,"Hz");
+		Check("Dither: lower sideband vs GetSpurLevel",
+			dBc(Amplitude(f - 100),carrier) - predicted,-6,0.5,"dB");
+		Check("Dither: upper sideband vs GetSpurLevel",
+			dBc(Amplitude(f + 100),carrier) - predicted,-6,0.5,"dB");
+		Check("Dither: sideband at 1 / 2 tick rate",dBc(Amplitude(f + 200),carrier),
+			-200,predicted,"dBc");
+		dither.Stop();
+		printf("  GetSpurLevel(%.0f Hz) = %.1f dBc\n",tickRate,predicted);
+	}
+
+	// ---- Tone bursts: 8 cycles of 41.234 kHz every 10 msec, 3 times ----
+	{
+		// The "timer" runs at MCLK, so its periods are whole samples
+		AD9833Burst burst(gen);
+		const double burstHz = 41234;
+		burst.Setup(SINE_WAVE,burstHz,8,10000,MCLK_HZ);
+		burst.Start(3);
+		double f = gen.GetActualProgrammedFrequency(REG0);
+		uint64_t clock = 0, lastOn = 0;
+		uint32_t ons = 0, offs = 0, badIntervals = 0, badStarts = 0, offCodes = 0;
+		double worstPhase = 0, phaseVsError = 0;
+		uint32_t wait;
+		do {
+			bool wasOn = !(chip.GetControl() & RESET_CMD);
+			uint32_t acc = chip.GetAccumulator();
+			wait = burst.Tick();
+			bool isOn = !(chip.GetControl() & RESET_CMD);
+			if ( isOn && !wasOn ) {
+				if ( ons++ && clock - lastOn != burst.GetOnTicks() + burst.GetOffTicks() )
+					badIntervals++;
+				lastOn = clock;
+			}
+			if ( wasOn && !isOn ) {
+				// Phase reached at the off edge, against a whole number of cycles
+				offs++;
+				double phase = (((int32_t)(acc << 4)) >> 4) * 360.0 / (1UL << 28);
+				worstPhase = fmax(worstPhase,fabs(phase));
+				phaseVsError = fmax(phaseVsError,
+					fabs(phase - burst.GetEdgeError() * f * 360.0));
+			}
+			if ( wait ) {
+				chip.Render(block,wait);
+				if ( isOn && !wasOn )
+					badStarts += block[0] < 511 || block[0] > 512 ||
+						block[(uint32_t)(MCLK_HZ / f / 4)] < 1020;
+				if ( !isOn )
+					for ( uint32_t n = 0; n < wait; n++ )
+						offCodes += block[n] < 511 || block[n] > 512;
+				clock += wait;
+			}
+		} while ( wait );
+		Check("Burst: bursts (on and off edges)",ons + offs,6,6,"");
+		Check("Burst: GetBursts / IsRunning after the last",
+			burst.GetBursts() * 10 + burst.IsRunning(),30,30,"");
+		Check("Burst: start to start != interval",badIntervals,0,0,"");
+		Check("Burst: interval",(burst.GetOnTicks() + burst.GetOffTicks()) * 1e6 / MCLK_HZ,
+			10000,10000,"us");
+		Check("Burst: not starting at phase 0",badStarts,0,0,"");
+		Check("Burst: phase at the off edge, worst",worstPhase,0,
+			180.0 * burstHz / MCLK_HZ * 1.01,"deg");
+		Check("Burst: that phase less GetEdgeError",phaseVsError,0,0.001,"deg");
+		Check("Burst: off samples not at midscale",offCodes,0,0,"");
+		gen.EnableOutput(true);
+	}
+
+	// ---- Bit-banged SPI: the chip decodes the same words ----
+	{
+		AD9833SoftSPI<SOFT_DATA_PIN,SOFT_CLOCK_PIN,SOFT_FSYNC_PIN> bus;
+		AD9833 banged(bus,MCLK_HZ);
+		AD9833Emulator softChip(MCLK_HZ);
+		Host.SetSoftSPI(SOFT_DATA_PIN,SOFT_CLOCK_PIN);
+		softChip.Attach(SOFT_FSYNC_PIN);
+		banged.Begin();
+		Host.Clear();
+		uint32_t before = softChip.wordsDecoded;
+		banged.ApplySignal(SQUARE_WAVE,REG1,1234.5,REG1,45.0);
+		banged.EnableOutput(true);
+		Check("Soft SPI: SCLK falling edges per word",
+			(double)Host.softClocks / Host.words,16,16,"");
+		Check("Soft SPI: words cut short by FSYNC",Host.framingErrors,0,0,"");
+		Check("Soft SPI: words decoded by the chip",softChip.wordsDecoded - before,
+			Host.words,Host.words,"");
+		Check("Soft SPI: chip FREQ1 word",softChip.GetFrequencyWord(1) ==
+			banged.GetFrequencyWord(REG1),1,1,"");
+		Check("Soft SPI: chip PHASE1 word",softChip.GetPhaseWord(1),512,512,"");
+		Check("Soft SPI: output frequency",softChip.GetOutputFrequency(),
+			1234.5 - 0.1,1234.5 + 0.1,"Hz");
+		Check("Soft SPI: chip control (square, REG1, running)",softChip.GetControl(),
+			SQUARE_WAVE | B28_CMD | FREQ1_OUTPUT_REG | PHASE1_OUTPUT_REG,
+			SQUARE_WAVE | B28_CMD | FREQ1_OUTPUT_REG | PHASE1_OUTPUT_REG,"");
+		softChip.Detach();
+		chip.Attach(FNC_TEST_PIN);
+	}
+
+	// ---- Array: transport devices are sent outside its SPI transaction ----
+	{
+		OverlapTransport transport;
+		AD9833 wired(FNC_TEST_PIN + 1,MCLK_HZ), queued(transport,MCLK_HZ);
+		AD9833 *devices[] = { &wired, &queued };
+		AD9833Array bus(devices,2);
+		bus.Begin();
+		bus.BeginUpdate();
+		wired.SetFrequency(REG0,1000);
+		queued.SetFrequency(REG0,2000);
+		bus.CommitUpdate();
+		bus.EnableOutput(true);
+		Check("Array: transport writes",transport.writes,3,3,"");
+		Check("Array: of those, inside an SPI transaction",transport.overlapped,0,0,"");
+	}
+
+	// ---- Async: a full queue with interrupts off drops, never waits ----
+	{
+		HostDMA dma(FNC_TEST_PIN);
+		AD9833 queued(dma,MCLK_HZ);
+		queued.Begin();
+		dma.RunUntilIdle();
+		noInterrupts();						// As in an ISR: no DMA interrupt
+		for ( uint8_t i = 1; i <= ASYNC_QUEUE_FRAMES + 1; i++ )
+			queued.SetPhase(REG0,i * 45.0);	// One frame each
+		Check("Async: frames dropped with interrupts off",dma.GetFramesDropped(),
+			2,2,"");
+		interrupts();
+		dma.RunUntilIdle();
+		queued.SetPhase(REG0,(ASYNC_QUEUE_FRAMES + 1) * 45.0);	// Not skipped
+		dma.RunUntilIdle();
+		Check("Async: chip PHASE0 word after the drop",chip.GetPhaseWord(0),
+			(ASYNC_QUEUE_FRAMES + 1) * 512,(ASYNC_QUEUE_FRAMES + 1) * 512,"");
+		gen.Begin();
+	}
+
+	// ---- Frequency meter: a chip whose MCLK is 40 ppm fast ----
+	{
+		AD9833Emulator fast(MCLK_HZ + MCLK_HZ / 25000);
+		AD9833FreqMeter meter(16000000UL);
+		fast.Attach(FNC_TEST_PIN);
+		gen.Begin();
+		gen.ApplySignal(SQUARE_WAVE,REG0,10000);
+		gen.EnableOutput(true);
+		Measure(fast,meter,1000,16e6);
+		Check("FreqMeter: frequency",meter.GetFrequency(),10000.3,10000.5,"Hz");
+		Check("FreqMeter: deviation before calibration",
+			meter.GetDeviation(gen.GetActualProgrammedFrequency(REG0)) * 1e6,39,41,"ppm");
+		Check("FreqMeter: jitter",meter.GetJitterTicks(),0,2,"tick");
+		Check("FreqMeter: Verify within 100 ppm / 10 ppm",
+			meter.Verify(gen,REG0,100e-6) * 10 + meter.Verify(gen,REG0,10e-6),10,10,"");
+		uint32_t reference = meter.Calibrate(gen,REG0);
+		Check("FreqMeter: calibrated reference",reference,
+			MCLK_HZ + MCLK_HZ / 25000 - 25,MCLK_HZ + MCLK_HZ / 25000 + 25,"Hz");
+		Check("FreqMeter: GetReferenceFrequency after",
+			gen.GetReferenceFrequency() == reference,1,1,"");
+		gen.SetFrequency(REG0,10000);				// Encoded with the new one
+		Measure(fast,meter,1000,16e6);
+		Check("FreqMeter: deviation after calibration",
+			meter.GetDeviation(gen.GetActualProgrammedFrequency(REG0)) * 1e6,-1,1,"ppm");
+		Check("FreqMeter: Verify within 2 ppm after",meter.Verify(gen,REG0,2e-6),1,1,"");
+		fast.Detach();
+		gen.SetReferenceFrequency(MCLK_HZ);
+		chip.Attach(FNC_TEST_PIN);
+		gen.Begin();
+
+		// Calibrating again and again, each time to a new value, once
+		// the shared table is full
+		AD9833 other(FNC_TEST_PIN + 2,MCLK_HZ);
+		size_t before = mallinfo2().uordblks;		// Heap bytes in use
+		for ( uint32_t i = 1; i <= 100; i++ ) {
+			gen.SetReferenceFrequency(MCLK_HZ + i);
+			other.SetReferenceFrequency(MCLK_HZ - i);
+		}
+		Check("SetReferenceFrequency x 100 on 2 devices: heap growth",
+			(double)(mallinfo2().uordblks - before),0,4 * sizeof(AD9833Reference),"bytes");
+		Check("SetReferenceFrequency: references after",gen.GetReferenceFrequency() == MCLK_HZ + 100 &&
+			other.GetReferenceFrequency() == MCLK_HZ - 100,1,1,"");
+		gen.SetReferenceFrequency(MCLK_HZ);
+	}
+
+	// ---- Throughput ----
+	gen.ApplySignal(SINE_WAVE,REG0,TONE_HZ);
+	uint64_t total = (uint64_t)(seconds * MCLK_HZ);
+	auto start = std::chrono::steady_clock::now();
+	for ( uint64_t done = 0; done < total; done += BLOCK_SAMPLES )
+		chip.Render(block,total - done < BLOCK_SAMPLES ? total - done : BLOCK_SAMPLES);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("\nRendered %.2f s of %lu Hz MCLK (sine) in %.3f s: %.0f Msamples/s, %.2fx real time\n",
+		seconds,MCLK_HZ,elapsed,total / elapsed / 1e6,seconds / elapsed);
+
+	chip.Detach();
+	printf("%u check(s) failed\n",failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+/*
+ * footprint.cpp
+ *
+ * RAM used by each library object, for the configuration this file is
+ * compiled with (make footprint builds it with the default settings,
+ * with FNC_PIN defined and with AD9833_INSTRUMENT). Sizes are the host
+ * compiler's; pointers and alignment are smaller on AVR. For AVR flash
+ * and RAM with the real toolchain, see extras/footprint.
+ *
+ *   ./footprint [channels]
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <AD9833.h>
+#include <AD9833Sweep.h>
+#include <AD9833Modulator.h>
+#include <AD9833Array.h>
+#include <AD9833Sequence.h>
+#include <AD9833Remote.h>
+#include <AD9833Encoder.h>
+
+#ifdef AD9833_INSTRUMENT
+#define CONFIGURATION	"AD9833_INSTRUMENT"
+#elif defined(FNC_PIN)
+#define CONFIGURATION	"FNC_PIN"
+#else
+#define CONFIGURATION	"default"
+#endif
+
+static void Row ( const char *name, size_t size ) {
+	printf("  %-20s %6zu\n",name,size);
+}
+
+int main ( int argc, char *argv[] ) {
+	unsigned channels = argc > 1 ? atoi(argv[1]) : 8;
+
+	printf("Configuration: %s (bytes, %u bit pointers)\n",CONFIGURATION,
+		(unsigned)sizeof(void *) * 8);
+	Row("AD9833",sizeof(AD9833));
+	Row("AD9833Reference",sizeof(AD9833Reference));
+	Row("AD9833Sweep",sizeof(AD9833Sweep));
+	Row("AD9833Modulator",sizeof(AD9833Modulator));
+	Row("AD9833Array",sizeof(AD9833Array));
+	Row("AD9833Sequence",sizeof(AD9833Sequence));
+	Row("AD9833Remote",sizeof(AD9833Remote));
+	Row("AD9833Encoder",sizeof(AD9833Encoder));
+#ifdef AD9833_INSTRUMENT
+	Row("AD9833Stats (shared)",sizeof(AD9833Stats));
+#endif
+	printf("  %u channels, one shared AD9833Reference: %zu\n",channels,
+		channels * sizeof(AD9833) + sizeof(AD9833Reference));
+	return 0;
+}
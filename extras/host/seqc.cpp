@@ -0,0 +1,67 @@
+/*
+ * seqc.cpp
+ *
+ * Stimulus script compiler for AD9833Sequence. Reads a script (see
+ * SequenceCompiler.h for the commands) and writes a header with the
+ * encoded sequence in PROGMEM, for #include in a sketch.
+ *
+ *   ./seqc script.seq [output.h [array name]]
+ *
+ * The output defaults to stdout and the name to the script's file
+ * name without its extension.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <fstream>
+#include <sstream>
+#include "SequenceCompiler.h"
+
+int main ( int argc, char *argv[] ) {
+	if ( argc < 2 || argc > 4 ) {
+		fprintf(stderr,"usage: %s script.seq [output.h [array name]]\n",argv[0]);
+		return 2;
+	}
+
+	std::ifstream in(argv[1]);
+	if ( !in ) {
+		fprintf(stderr,"%s: cannot open\n",argv[1]);
+		return 1;
+	}
+	std::stringstream script;
+	script << in.rdbuf();
+
+	std::string name;
+	if ( argc == 4 )
+		name = argv[3];
+	else {
+		name = argv[1];
+		size_t slash = name.find_last_of('/');
+		if ( slash != std::string::npos ) name = name.substr(slash + 1);
+		name = name.substr(0,name.find('.'));
+		for ( size_t i = 0; i < name.size(); i++ )
+			if ( !isalnum((unsigned char)name[i]) ) name[i] = '_';
+	}
+
+	SequenceCompiler compiler;
+	if ( !compiler.Compile(script.str()) ) {
+		fprintf(stderr,"%s:%d: %s\n",argv[1],compiler.errorLine,compiler.error.c_str());
+		return 1;
+	}
+
+	FILE *out = argc >= 3 ? fopen(argv[2],"w") : stdout;
+	if ( out == NULL ) {
+		perror(argv[2]);
+		return 1;
+	}
+	const char *source = strrchr(argv[1],'/');
+	compiler.WriteHeader(out,name.c_str(),source ? source + 1 : argv[1]);
+	if ( out != stdout ) fclose(out);
+	return 0;
+}
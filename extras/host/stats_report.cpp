@@ -0,0 +1,87 @@
+/*
+ * stats_report.cpp
+ *
+ * Host run of the optional instrumentation (AD9833Stats.h). The library
+ * is built a second time with AD9833_INSTRUMENT and AD9833_DEBUG_PIN,
+ * a mix of calls is made, and the counters and latency histograms are
+ * printed as they would be read back on a board.
+ *
+ *   ./stats_report [iterations]
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include "HostArduino.h"
+#include <AD9833.h>
+
+#if !defined(AD9833_INSTRUMENT) || !defined(AD9833_DEBUG_PIN)
+#error "Build with -DAD9833_INSTRUMENT -DAD9833_DEBUG_PIN=n (see Makefile)"
+#endif
+
+#define FNC_TEST_PIN		4
+#define CALLS_PER_ITERATION	9		// Timed calls in the loop (not BeginUpdate)
+
+static const char *methodNames[STAT_METHODS] = {
+	"ApplySignal", "Retune", "Reset", "SetFrequency", "IncrementFrequency",
+	"Frequency words", "SetPhase", "IncrementPhase", "Phase words",
+	"Control", "CommitUpdate"
+};
+
+static const char *registerNames[STAT_REGISTERS] = {
+	"control", "FREQ0", "FREQ1", "PHASE0", "PHASE1"
+};
+
+static uint32_t debugPulses;
+
+int main ( int argc, char *argv[] ) {
+	uint32_t iterations = argc > 1 ? strtoul(argv[1],NULL,0) : 10000UL;
+
+	AD9833 gen(FNC_TEST_PIN);
+	Host.SetSelectMask(1ULL << FNC_TEST_PIN);	// The debug pin is not a select
+	gen.Begin();
+	gen.GetStats().Clear();
+
+	for ( uint32_t i = 0; i < iterations; i++ ) {
+		uint8_t before = Host.pinState[AD9833_DEBUG_PIN];
+		gen.ApplySignal(SINE_WAVE,REG0,1000.0 + (i & 255));
+		gen.EnableOutput(true);					// Redundant after the first
+		gen.IncrementFrequency(REG0,0.1);
+		gen.SetPhase(REG1,(i & 3) * 90);
+		gen.IncrementPhaseWord(REG1,0);			// Always redundant
+		gen.Retune(3000.0 + (i & 255),(i & 7) * 45);
+		gen.BeginUpdate();
+		gen.SetFrequency(REG1,2000.0 + (i & 255));
+		gen.SetOutputSource(i & 1 ? REG1 : REG0);
+		gen.CommitUpdate();
+		debugPulses += before == LOW && Host.pinState[AD9833_DEBUG_PIN] == LOW;
+	}
+
+	AD9833Stats &stats = gen.GetStats();
+	printf("%u iterations, %u SPI transactions, %u words on the bus\n",
+		iterations,stats.transactions,Host.words);
+	printf("\n%-10s %10s %10s\n","register","words","redundant");
+	for ( uint8_t r = 0; r < STAT_REGISTERS; r++ )
+		printf("%-10s %10u %10u\n",registerNames[r],stats.wordsWritten[r],
+			stats.redundantWrites[r]);
+
+	printf("\nLatency histograms (host TSC cycles; bucket n is 2^n .. 2^(n+1)-1)\n");
+	for ( uint8_t m = 0; m < STAT_METHODS; m++ ) {
+		if ( stats.calls[m] == 0 ) continue;
+		printf("%-20s %8u calls ",methodNames[m],stats.calls[m]);
+		for ( uint8_t b = 0; b < AD9833_STATS_BUCKETS; b++ )
+			if ( stats.histogram[m][b] )
+				printf(" [2^%u]%u",b,stats.histogram[m][b]);
+		printf("\n");
+	}
+	uint32_t calls = 0;
+	for ( uint8_t m = 0; m < STAT_METHODS; m++ ) calls += stats.calls[m];
+	printf("\nCalls counted per iteration: %.2f (the loop makes %u)\n",
+		(double)calls / iterations,CALLS_PER_ITERATION);
+	printf("Debug pin %u left LOW after every iteration: %s\n",AD9833_DEBUG_PIN,
+		debugPulses == iterations ? "yes" : "NO");
+	return 0;
+}
@@ -0,0 +1,306 @@
+/*
+ * AD9833Client.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+#include "AD9833Client.h"
+#include <AD9833Fast.h>				// Same encoders as the library
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+static const struct { uint32_t baud; speed_t speed; } speeds[] = {
+	{ 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+	{ 115200, B115200 }, { 230400, B230400 }, { 460800, B460800 },
+	{ 500000, B500000 }, { 921600, B921600 }, { 1000000, B1000000 },
+	{ 2000000, B2000000 }
+};
+
+static uint64_t NowMillis ( void ) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static void Write32 ( uint8_t *data, uint32_t value ) {
+	data[0] = value >> 24;
+	data[1] = value >> 16;
+	data[2] = value >> 8;
+	data[3] = value;
+}
+
+AD9833Client :: AD9833Client ( uint32_t refFrequencyHz ) {
+	fd = -1;
+	owned = false;
+	error = 0;
+	refFrequency = refFrequencyHz;
+	timeoutMillis = CLIENT_DEFAULT_TIMEOUT;
+	replyErrors = 0;
+	batching = false;
+	batchLength = 0;
+	pingCount = 0;
+	rxAt = rxCount = 0;
+}
+
+AD9833Client :: ~AD9833Client ( void ) {
+	Close();
+}
+
+bool AD9833Client :: Open ( const char *device, uint32_t baud ) {
+	Close();
+	speed_t speed = 0;
+	for ( size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++ )
+		if ( speeds[i].baud == baud ) speed = speeds[i].speed;
+	if ( speed == 0 ) {
+		error = EINVAL;
+		return false;
+	}
+
+	int port = open(device,O_RDWR | O_NOCTTY);
+	struct termios tio;
+	if ( port < 0 || tcgetattr(port,&tio) < 0 ) {
+		error = errno;
+		if ( port >= 0 ) close(port);
+		return false;
+	}
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+	cfsetispeed(&tio,speed);
+	cfsetospeed(&tio,speed);
+	if ( tcsetattr(port,TCSANOW,&tio) < 0 ) {
+		error = errno;
+		close(port);
+		return false;
+	}
+	tcflush(port,TCIOFLUSH);
+	fd = port;
+	owned = true;
+	rxAt = rxCount = 0;
+	return true;
+}
+
+void AD9833Client :: Attach ( int descriptor ) {
+	Close();
+	fd = descriptor;
+	owned = false;
+	rxAt = rxCount = 0;
+}
+
+void AD9833Client :: Close ( void ) {
+	if ( fd >= 0 && owned ) close(fd);
+	fd = -1;
+	owned = false;
+}
+
+// ------------------------------ Commands -----------------------------
+
+int AD9833Client :: SetFrequencyWord ( Registers freqReg, uint32_t freqWord, bool wait ) {
+	uint8_t args[5] = { (uint8_t)(freqReg == REG1) };
+	Write32(args + 1,freqWord & FREQ_WORD_MASK);
+	return Command(REMOTE_FREQ_WORD,args,sizeof(args),wait);
+}
+
+int AD9833Client :: SetFrequency ( Registers freqReg, float frequency, bool wait ) {
+	if ( frequency > refFrequency / 2 ) frequency = refFrequency / 2;
+	return SetFrequencyWord(freqReg,AD9833FrequencyWord(frequency,refFrequency),wait);
+}
+
+int AD9833Client :: SetPhaseWord ( Registers phaseReg, uint16_t phaseWord, bool wait ) {
+	uint8_t args[3] = { (uint8_t)(phaseReg == REG1), (uint8_t)((phaseWord >> 8) & 0x0F),
+		(uint8_t)phaseWord };
+	return Command(REMOTE_PHASE_WORD,args,sizeof(args),wait);
+}
+
+int AD9833Client :: SetPhase ( Registers phaseReg, float phaseInDeg, bool wait ) {
+	phaseInDeg = fmod(phaseInDeg,360);
+	if ( phaseInDeg < 0 ) phaseInDeg += 360;
+	return SetPhaseWord(phaseReg,AD9833PhaseWord(phaseInDeg),wait);
+}
+
+int AD9833Client :: SetWaveform ( Registers waveFormReg, WaveformType waveType, bool wait ) {
+	uint8_t type;
+	switch ( waveType ) {
+		case TRIANGLE_WAVE:		type = 1; break;
+		case SQUARE_WAVE:		type = 2; break;
+		case HALF_SQUARE_WAVE:	type = 3; break;
+		default:				type = 0; break;
+	}
+	uint8_t args[2] = { (uint8_t)(waveFormReg == REG1), type };
+	return Command(REMOTE_WAVEFORM,args,sizeof(args),wait);
+}
+
+int AD9833Client :: SetOutputSource ( Registers freqReg, Registers phaseReg, bool wait ) {
+	if ( phaseReg == SAME_AS_REG0 ) phaseReg = freqReg;
+	uint8_t args[2] = { (uint8_t)(freqReg == REG1), (uint8_t)(phaseReg == REG1) };
+	return Command(REMOTE_OUTPUT,args,sizeof(args),wait);
+}
+
+int AD9833Client :: EnableOutput ( bool enable, bool wait ) {
+	uint8_t args[1] = { (uint8_t)enable };
+	return Command(REMOTE_ENABLE,args,sizeof(args),wait);
+}
+
+int AD9833Client :: Reset ( bool wait ) {
+	return Command(REMOTE_RESET,NULL,0,wait);
+}
+
+void AD9833Client :: BeginBatch ( void ) {
+	batching = true;
+	batchLength = 0;
+}
+
+int AD9833Client :: CommitBatch ( bool wait ) {
+	batching = false;
+	if ( batchLength == 0 ) return REMOTE_OK;
+	return Send(REMOTE_BATCH,batch,batchLength,wait);
+}
+
+int AD9833Client :: Sequence ( Registers freqReg, const float *frequencies,
+		uint8_t count, uint32_t dwellMicros, bool repeat ) {
+	if ( count == 0 || count > REMOTE_SEQUENCE_STEPS ) return REMOTE_BAD_LENGTH;
+	uint8_t args[6 + 4 * REMOTE_SEQUENCE_STEPS];
+	args[0] = freqReg == REG1;
+	Write32(args + 1,dwellMicros);
+	args[5] = repeat;
+	for ( uint8_t i = 0; i < count; i++ ) {
+		float frequency = frequencies[i];
+		if ( frequency > refFrequency / 2 ) frequency = refFrequency / 2;
+		Write32(args + 6 + 4 * i,AD9833FrequencyWord(frequency,refFrequency));
+	}
+	return Send(REMOTE_SEQUENCE,args,6 + 4 * count,true);
+}
+
+int AD9833Client :: Stop ( bool wait ) {
+	return Send(REMOTE_STOP,NULL,0,wait);
+}
+
+int AD9833Client :: Ping ( void ) {
+	uint8_t echo[4];
+	Write32(echo,((uint32_t)++pingCount << 24) | ((uint32_t)NowMillis() & 0xFFFFFF));
+	return Send(REMOTE_PING,echo,sizeof(echo),true,echo);
+}
+
+// ------------------------------ Framing ------------------------------
+
+/*
+ * A register command: queued while batching, else sent on its own
+ */
+int AD9833Client :: Command ( uint8_t command, const uint8_t *args, uint8_t count,
+		bool wait ) {
+	if ( !batching ) return Send(command,args,count,wait);
+	if ( batchLength + 1 + count > REMOTE_MAX_FRAME - 1 ) return REMOTE_BAD_LENGTH;
+	batch[batchLength++] = command;
+	for ( uint8_t i = 0; i < count; i++ ) batch[batchLength++] = args[i];
+	return REMOTE_OK;
+}
+
+int AD9833Client :: Send ( uint8_t command, const uint8_t *args, uint8_t count,
+		bool wait, const uint8_t *echo ) {
+	if ( fd < 0 ) {
+		error = EBADF;
+		return CLIENT_TIMEOUT;
+	}
+	uint8_t frame[REMOTE_MAX_FRAME + 3];
+	frame[0] = REMOTE_SYNC;
+	frame[1] = count + 1;
+	frame[2] = command | (wait ? 0 : REMOTE_NO_REPLY);
+	for ( uint8_t i = 0; i < count; i++ ) frame[3 + i] = args[i];
+	uint8_t crc = 0;
+	for ( uint8_t i = 1; i < count + 3; i++ ) crc = AD9833Remote::CRC8(crc,frame[i]);
+	frame[count + 3] = crc;
+
+	for ( size_t sent = 0, length = count + 4; sent < length; ) {
+		ssize_t n = write(fd,frame + sent,length - sent);
+		if ( n < 0 ) {
+			if ( errno == EINTR || errno == EAGAIN ) continue;
+			error = errno;
+			return CLIENT_TIMEOUT;
+		}
+		sent += n;
+	}
+	return wait ? Reply(command,echo,echo ? count : 0) : REMOTE_OK;
+}
+
+/*
+ * Read replies until the one for 'command' arrives. Replies with a bad
+ * CRC, or for another command, are counted in replyErrors and skipped.
+ */
+int AD9833Client :: Reply ( uint8_t command, const uint8_t *echo, uint8_t echoCount ) {
+	uint64_t deadline = NowMillis() + timeoutMillis;
+	uint8_t data, length, body[REMOTE_MAX_FRAME];
+
+	for ( ;; ) {
+		do {
+			if ( !ReadByte(data,deadline) ) return CLIENT_TIMEOUT;
+		} while ( data != REMOTE_SYNC );
+		if ( !ReadByte(length,deadline) ) return CLIENT_TIMEOUT;
+		if ( length < 2 || length > REMOTE_MAX_FRAME ) {
+			replyErrors++;
+			continue;
+		}
+		uint8_t crc = AD9833Remote::CRC8(0,length);
+		for ( uint8_t i = 0; i < length; i++ ) {
+			if ( !ReadByte(body[i],deadline) ) return CLIENT_TIMEOUT;
+			crc = AD9833Remote::CRC8(crc,body[i]);
+		}
+		if ( !ReadByte(data,deadline) ) return CLIENT_TIMEOUT;
+		if ( data != crc ) {
+			replyErrors++;
+			continue;
+		}
+		if ( body[0] == REMOTE_ERROR ) return body[1];	// Our frame was corrupted
+		if ( body[0] != (command | REMOTE_REPLY) ) {
+			replyErrors++;
+			continue;
+		}
+		if ( body[1] == REMOTE_OK && echo ) {
+			if ( length - 2 != echoCount ) return REMOTE_BAD_LENGTH;
+			for ( uint8_t i = 0; i < echoCount; i++ )
+				if ( body[2 + i] != echo[i] ) return REMOTE_BAD_ARGUMENT;
+		}
+		return body[1];
+	}
+}
+
+/*
+ * Buffered, so a reply costs one read() rather than one per byte
+ */
+bool AD9833Client :: ReadByte ( uint8_t &data, uint64_t deadline ) {
+	while ( rxAt == rxCount ) {
+		uint64_t now = NowMillis();
+		if ( now >= deadline ) return false;
+		struct pollfd wait = { fd, POLLIN, 0 };
+		if ( poll(&wait,1,(int)(deadline - now)) <= 0 ) continue;
+		ssize_t n = read(fd,rx,sizeof(rx));
+		if ( n < 0 && errno != EAGAIN && errno != EINTR ) {
+			error = errno;
+			return false;
+		}
+		rxAt = 0;
+		rxCount = n > 0 ? n : 0;
+	}
+	data = rx[rxAt++];
+	return true;
+}
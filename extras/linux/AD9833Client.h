@@ -0,0 +1,116 @@
+/*
+ * AD9833Client.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * PC side of the AD9833Remote serial protocol (see AD9833Remote.h).
+ * Frequencies and phases are encoded here, with the same encoders as
+ * the library, so the board receives finished register words.
+ *
+ *	AD9833Client board;
+ *	if ( !board.Open("/dev/ttyUSB0",1000000) ) ... board.GetError()
+ *	board.SetFrequency(REG0,1000.0);
+ *
+ *	board.BeginBatch();				// One frame, one SPI transaction
+ *	board.SetFrequency(REG1,2000.0);
+ *	board.SetOutputSource(REG1);
+ *	board.CommitBatch();
+ *
+ * Commands return the reply status (REMOTE_OK ...), or CLIENT_TIMEOUT.
+ * With 'wait' false the command is sent with REMOTE_NO_REPLY and returns
+ * REMOTE_OK at once; Ping or any waited command afterwards confirms the
+ * board has caught up. Inside a batch the commands only queue.
+ */
+
+#ifndef __AD9833_CLIENT__
+
+#define __AD9833_CLIENT__
+
+#include <AD9833Remote.h>
+
+#define CLIENT_TIMEOUT			-1
+#define CLIENT_DEFAULT_TIMEOUT	500		// Milliseconds to wait for a reply
+
+class AD9833Client {
+
+public:
+
+	AD9833Client ( uint32_t refFrequencyHz = 25000000UL );
+	~AD9833Client ( void );
+
+	// Open a serial port: raw 8N1 at 'baud', no flow control
+	bool Open ( const char *device, uint32_t baud );
+
+	// Use a descriptor that is already open and raw (a pty, a socket)
+	void Attach ( int fd );
+
+	void Close ( void );
+
+	int SetFrequencyWord ( Registers freqReg, uint32_t freqWord, bool wait = true );
+	int SetFrequency ( Registers freqReg, float frequency, bool wait = true );
+	int SetPhaseWord ( Registers phaseReg, uint16_t phaseWord, bool wait = true );
+	int SetPhase ( Registers phaseReg, float phaseInDeg, bool wait = true );
+	int SetWaveform ( Registers waveFormReg, WaveformType waveType, bool wait = true );
+	int SetOutputSource ( Registers freqReg, Registers phaseReg = SAME_AS_REG0,
+		bool wait = true );
+	int EnableOutput ( bool enable, bool wait = true );
+	int Reset ( bool wait = true );
+
+	// Queue the commands that follow and send them as one REMOTE_BATCH
+	void BeginBatch ( void );
+	int CommitBatch ( bool wait = true );
+
+	// Step freqReg through count (up to REMOTE_SEQUENCE_STEPS) frequencies
+	int Sequence ( Registers freqReg, const float *frequencies, uint8_t count,
+		uint32_t dwellMicros, bool repeat = false );
+	int Stop ( bool wait = true );
+
+	// Round trip with an echo check. Returns REMOTE_OK or an error.
+	int Ping ( void );
+
+	// errno of the last failed system call
+	int GetError ( void ) { return error; }
+
+	uint32_t		timeoutMillis;
+	uint32_t		replyErrors;		// Replies with a bad CRC or the wrong command
+
+private:
+
+	int				Command ( uint8_t command, const uint8_t *args, uint8_t count,
+						bool wait );
+	int				Send ( uint8_t command, const uint8_t *args, uint8_t count,
+						bool wait, const uint8_t *echo = NULL );
+	int				Reply ( uint8_t command, const uint8_t *echo, uint8_t echoCount );
+	bool			ReadByte ( uint8_t &data, uint64_t deadline );
+
+	int				fd;
+	bool			owned;
+	int				error;
+	uint32_t		refFrequency;
+
+	bool			batching;
+	uint8_t			batch[REMOTE_MAX_FRAME];
+	uint8_t			batchLength;
+	uint8_t			pingCount;
+
+	uint8_t			rx[256];			// Received, not yet parsed
+	uint16_t		rxAt, rxCount;
+};
+
+#endif
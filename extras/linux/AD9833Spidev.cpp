@@ -0,0 +1,112 @@
+/*
+ * AD9833Spidev.cpp
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ */
+
+#include "AD9833Spidev.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+AD9833Spidev :: AD9833Spidev ( const char *device, uint32_t clockHz ) {
+	this->device = device;
+	this->clockHz = clockHz;
+	fd = -1;
+	error = 0;
+	syscalls = 0;
+}
+
+AD9833Spidev :: ~AD9833Spidev ( void ) {
+	End();
+}
+
+/*
+ * Open the spidev device in the AD9833 SPI mode. On failure the device
+ * stays closed, GetError returns the errno and Write does nothing.
+ */
+void AD9833Spidev :: Begin ( void ) {
+	uint8_t mode = SPI_MODE_2, bits = 8;
+
+	End();
+	syscalls = 0;
+	error = 0;
+	fd = open(device,O_RDWR);
+	if ( fd < 0 ) {
+		error = errno;
+		return;
+	}
+	if ( ioctl(fd,SPI_IOC_WR_MODE,&mode) < 0 ||
+		 ioctl(fd,SPI_IOC_WR_BITS_PER_WORD,&bits) < 0 ||
+		 ioctl(fd,SPI_IOC_WR_MAX_SPEED_HZ,&clockHz) < 0 ) {
+		error = errno;
+		End();
+	}
+}
+
+/*
+ * One transfer per 16-bit word, all in one ioctl. cs_change on every
+ * transfer but the last raises FSYNC between words; the kernel raises
+ * it after the last one anyway.
+ */
+bool AD9833Spidev :: Write ( const uint16_t *words, uint8_t count ) {
+	struct spi_ioc_transfer transfers[UPDATE_BUFFER_SIZE];
+	uint8_t bytes[2 * UPDATE_BUFFER_SIZE];
+
+	if ( fd < 0 ) return false;
+	if ( count == 0 ) return true;
+	if ( count > UPDATE_BUFFER_SIZE ) count = UPDATE_BUFFER_SIZE;
+
+	memset(transfers,0,count * sizeof(transfers[0]));
+	for ( uint8_t i = 0; i < count; i++ ) {
+		bytes[2 * i] = highByte(words[i]);
+		bytes[2 * i + 1] = lowByte(words[i]);
+		transfers[i].tx_buf = (uintptr_t)&bytes[2 * i];
+		transfers[i].len = 2;
+		transfers[i].speed_hz = clockHz;
+		transfers[i].bits_per_word = 8;
+		transfers[i].cs_change = i + 1 < count;
+	}
+
+	syscalls++;
+	if ( ioctl(fd,SPI_IOC_MESSAGE(count),transfers) < 0 ) {
+		error = errno;
+		return false;
+	}
+	return true;
+}
+
+void AD9833Spidev :: End ( void ) {
+	if ( fd >= 0 ) close(fd);
+	fd = -1;
+}
+
+bool AD9833Spidev :: IsOpen ( void ) {
+	return fd >= 0;
+}
+
+int AD9833Spidev :: GetError ( void ) {
+	return error;
+}
+
+uint32_t AD9833Spidev :: GetSyscalls ( void ) {
+	return syscalls;
+}
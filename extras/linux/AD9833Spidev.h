@@ -0,0 +1,79 @@
+/*
+ * AD9833Spidev.h
+ *
+ * Copyright 2016 Bill Williams <wlwilliams1952@gmail.com, github/BillWilliams1952>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ * AD9833Transport for Linux spidev (/dev/spidevX.Y), for single board
+ * computers. Wire FSYNC to the chip select of the spidev device. Each
+ * update is sent with ONE SPI_IOC_MESSAGE ioctl holding one 16-bit
+ * transfer per word, with cs_change set between them so the kernel
+ * raises FSYNC after every word.
+ *
+ *	AD9833Spidev bus("/dev/spidev0.0");
+ *	AD9833 gen(bus);
+ *	gen.Begin();
+ *	if ( !bus.IsOpen() ) ... bus.GetError() is the errno
+ */
+
+#ifndef __AD9833_SPIDEV__
+
+#define __AD9833_SPIDEV__
+
+#include <AD9833.h>
+
+#define SPIDEV_DEFAULT_DEVICE	"/dev/spidev0.0"
+#define SPIDEV_DEFAULT_CLOCK	10000000UL	// Hz. Most SBC controllers
+											// top out well below 40 MHz.
+
+class AD9833Spidev : public AD9833Transport {
+
+public:
+
+	AD9833Spidev ( const char *device = SPIDEV_DEFAULT_DEVICE,
+		uint32_t clockHz = SPIDEV_DEFAULT_CLOCK );
+	~AD9833Spidev ( void );
+
+	// Open the device and set SPI mode 2, 8 bit words, clockHz
+	void Begin ( void );
+
+	// Send the words with one SPI_IOC_MESSAGE(count) ioctl. False if
+	// the device is not open or the ioctl failed.
+	bool Write ( const uint16_t *words, uint8_t count );
+
+	// Close the device (also done by the destructor)
+	void End ( void );
+
+	bool IsOpen ( void );
+
+	// errno of the last failure, 0 if none
+	int GetError ( void );
+
+	// System calls made by Write since Begin
+	uint32_t GetSyscalls ( void );
+
+private:
+
+	const char		*device;
+	uint32_t		clockHz;
+	int				fd;
+	int				error;
+	uint32_t		syscalls;
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * LinuxArduino.cpp
+ *
+ * Linux implementation of the stand-in Arduino core in extras/host, for
+ * running the library on a single board computer. Delays and millis()
+ * use the real clock. There are no GPIO pins or SPI library here: all
+ * SPI traffic goes through an AD9833Transport such as AD9833Spidev,
+ * which owns FSYNC.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <time.h>
+
+SPIClass SPI;
+bool hostInterruptsOn = true;
+
+static uint64_t NowMicros ( void ) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+static const uint64_t startMicros = NowMicros();
+
+// ------------------------ Arduino core -----------------------------
+
+void pinMode ( uint8_t, uint8_t ) { }
+
+void digitalWrite ( uint8_t, uint8_t ) { }
+
+int digitalRead ( uint8_t ) {
+	return LOW;
+}
+
+void delay ( unsigned long ms ) {
+	struct timespec wait = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000L };
+	nanosleep(&wait,NULL);
+}
+
+void delayMicroseconds ( unsigned int us ) {
+	struct timespec wait = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000L };
+	nanosleep(&wait,NULL);
+}
+
+unsigned long millis ( void ) {
+	return (NowMicros() - startMicros) / 1000;
+}
+
+unsigned long micros ( void ) {
+	return NowMicros() - startMicros;
+}
+
+// ------------------ SPI library (not wired) ------------------------
+
+void SPIClass :: begin ( void ) { }
+
+void SPIClass :: end ( void ) { }
+
+void SPIClass :: setDataMode ( uint8_t ) { }
+
+void SPIClass :: beginTransaction ( SPISettings ) { }
+
+void SPIClass :: endTransaction ( void ) { }
+
+uint8_t SPIClass :: transfer ( uint8_t ) {
+	return 0;
+}
+
+uint16_t SPIClass :: transfer16 ( uint16_t ) {
+	return 0;
+}
+
+void SPIClass :: transfer ( void *, size_t ) { }
@@ -0,0 +1,148 @@
+/*
+ * fake_spidev.c
+ *
+ * LD_PRELOAD stand-in for a spidev device with an AD9833 on it. Opening
+ * any /dev/spidev* path succeeds (it is backed by /dev/null) and its
+ * ioctls are checked and counted instead of reaching a kernel driver:
+ *
+ *	LD_PRELOAD=./build/fake_spidev.so ./build/spidev_bench
+ *
+ * SPI_IOC_MESSAGE transfers are split into 16-bit words as the AD9833
+ * would see them. A transfer that ends with half a word before FSYNC
+ * rises (cs_change, or the end of the message) is a framing error.
+ * Totals are printed to stderr at exit; FAKE_SPIDEV_LOG=file also logs
+ * every word.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+static int fakeFd = -1;
+static FILE *wordLog;
+static unsigned long ioctls, messages, transfers, words, csEdges, framingErrors;
+static unsigned long badSetup;
+
+static int (*realOpen) ( const char *, int, ... );
+static int (*realClose) ( int );
+static int (*realIoctl) ( int, unsigned long, ... );
+
+static void Report ( void ) {
+	if ( ioctls == 0 ) return;
+	fprintf(stderr,"fake_spidev: %lu ioctls, %lu messages, %lu transfers, "
+		"%lu words, %lu FSYNC frames, %lu framing errors, %lu bad setup\n",
+		ioctls,messages,transfers,words,csEdges,framingErrors,badSetup);
+}
+
+static void Init ( void ) {
+	if ( realOpen ) return;
+	realOpen = (int (*)( const char *, int, ... ))dlsym(RTLD_NEXT,"open");
+	realClose = (int (*)( int ))dlsym(RTLD_NEXT,"close");
+	realIoctl = (int (*)( int, unsigned long, ... ))dlsym(RTLD_NEXT,"ioctl");
+	if ( getenv("FAKE_SPIDEV_LOG") )
+		wordLog = fopen(getenv("FAKE_SPIDEV_LOG"),"w");
+	atexit(Report);
+}
+
+static int OpenAny ( const char *path, int flags, mode_t mode ) {
+	Init();
+	if ( strncmp(path,"/dev/spidev",11) != 0 )
+		return realOpen(path,flags,mode);
+	fakeFd = realOpen("/dev/null",O_RDWR);
+	return fakeFd;
+}
+
+int open ( const char *path, int flags, ... ) {
+	mode_t mode = 0;
+	if ( flags & O_CREAT ) {
+		va_list args;
+		va_start(args,flags);
+		mode = va_arg(args,mode_t);
+		va_end(args);
+	}
+	return OpenAny(path,flags,mode);
+}
+
+int open64 ( const char *path, int flags, ... ) {
+	mode_t mode = 0;
+	if ( flags & O_CREAT ) {
+		va_list args;
+		va_start(args,flags);
+		mode = va_arg(args,mode_t);
+		va_end(args);
+	}
+	return OpenAny(path,flags,mode);
+}
+
+int close ( int fd ) {
+	Init();
+	if ( fd == fakeFd ) fakeFd = -1;
+	return realClose(fd);
+}
+
+/*
+ * Check one SPI message the way the AD9833 would take it
+ */
+static void Message ( const struct spi_ioc_transfer *xfer, unsigned count ) {
+	unsigned partial = 0;				/* Bytes of an unfinished word */
+	uint16_t word = 0;
+
+	messages++;
+	csEdges++;							/* FSYNC falls */
+	for ( unsigned t = 0; t < count; t++ ) {
+		const uint8_t *tx = (const uint8_t *)(uintptr_t)xfer[t].tx_buf;
+		transfers++;
+		if ( xfer[t].bits_per_word != 0 && xfer[t].bits_per_word != 8 )
+			badSetup++;
+		for ( uint32_t b = 0; b < xfer[t].len; b++ ) {
+			word = (uint16_t)(word << 8 | (tx ? tx[b] : 0));
+			if ( ++partial == 2 ) {
+				words++;
+				if ( wordLog ) fprintf(wordLog,"%04X\n",word);
+				partial = 0;
+			}
+		}
+		if ( xfer[t].cs_change && t + 1 < count ) {
+			if ( partial ) framingErrors++;
+			partial = 0;
+			csEdges++;					/* FSYNC rises and falls again */
+		}
+	}
+	if ( partial ) framingErrors++;
+}
+
+int ioctl ( int fd, unsigned long request, ... ) {
+	va_list args;
+	void *arg;
+
+	Init();
+	va_start(args,request);
+	arg = va_arg(args,void *);
+	va_end(args);
+	if ( fd != fakeFd || fd < 0 )
+		return realIoctl(fd,request,arg);
+
+	ioctls++;
+	if ( _IOC_TYPE(request) != SPI_IOC_MAGIC ) return -1;
+	if ( _IOC_NR(request) == 0 && _IOC_DIR(request) == _IOC_WRITE ) {
+		Message((const struct spi_ioc_transfer *)arg,
+			_IOC_SIZE(request) / sizeof(struct spi_ioc_transfer));
+		return 0;
+	}
+	if ( request == SPI_IOC_WR_MODE && *(uint8_t *)arg != SPI_MODE_2 )
+		badSetup++;
+	return 0;
+}
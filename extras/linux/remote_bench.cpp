@@ -0,0 +1,218 @@
+/*
+ * remote_bench.cpp
+ *
+ * Throughput and latency of the AD9833Remote serial protocol over a
+ * pseudo terminal. A device thread plays the board: it reads the pty,
+ * feeds AD9833Remote::Receive, calls Poll and writes the replies back.
+ * The AD9833 behind it has a transport that only counts. The main
+ * thread drives it with AD9833Client (make remote):
+ *
+ *   ./remote_bench [iterations]
+ *
+ * A pty has no baud rate, so these are the protocol and host costs; on
+ * a real link the wire adds (frame bytes * 10 / baud) per frame.
+ *
+ * Columns:
+ *   per second	commands (or batches) per second
+ *   bytes		frame bytes sent per command
+ *   SPI tx		transport Write calls per command
+ *   words		SPI words per command
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <AD9833.h>
+#include <AD9833Remote.h>
+#include "AD9833Client.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * Stands in for the SPI bus: counts transactions and words
+ */
+class CountingTransport : public AD9833Transport {
+public:
+	CountingTransport ( void ) : transactions(0), words(0) { }
+	void Begin ( void ) { }
+	bool Write ( const uint16_t *, uint8_t count ) {
+		transactions++;
+		words += count;
+		return true;
+	}
+	std::atomic<uint32_t>	transactions;
+	std::atomic<uint32_t>	words;
+};
+
+static int deviceFd = -1;
+static std::atomic<bool> running(true);
+
+static void DeviceWrite ( const uint8_t *data, uint8_t count ) {
+	while ( count > 0 ) {
+		ssize_t n = write(deviceFd,data,count);
+		if ( n <= 0 ) return;
+		data += n;
+		count -= n;
+	}
+}
+
+/*
+ * The board: Receive is called with no more than half the ring buffer
+ * between Polls, as a UART interrupt would against a busy loop()
+ */
+static void Device ( AD9833Remote *remote ) {
+	uint8_t data[256];
+	while ( running ) {
+		struct pollfd wait = { deviceFd, POLLIN, 0 };
+		if ( poll(&wait,1,10) <= 0 ) {
+			remote->Poll();
+			continue;
+		}
+		ssize_t n = read(deviceFd,data,sizeof(data));
+		for ( ssize_t i = 0; i < n; ) {
+			for ( ssize_t end = std::min(n,i + REMOTE_BUFFER_SIZE / 2); i < end; i++ )
+				remote->Receive(data[i]);
+			remote->Poll();
+		}
+	}
+}
+
+static bool OpenPty ( int &master, int &slave ) {
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+	if ( master < 0 || grantpt(master) < 0 || unlockpt(master) < 0 ) return false;
+	slave = open(ptsname(master),O_RDWR | O_NOCTTY);
+	if ( slave < 0 ) return false;
+	struct termios tio;
+	for ( int fd : { master, slave } ) {
+		if ( tcgetattr(fd,&tio) < 0 ) return false;
+		cfmakeraw(&tio);
+		if ( tcsetattr(fd,TCSANOW,&tio) < 0 ) return false;
+	}
+	return true;
+}
+
+static CountingTransport bus;
+
+struct Row {
+	uint32_t	transactions, words;		// At the start
+	Clock::time_point start;
+	Row ( void ) : transactions(bus.transactions), words(bus.words),
+		start(Clock::now()) { }
+	// 'bytes' is the frame bytes per command
+	void Print ( const char *name, uint32_t count, uint32_t bytes ) {
+		std::chrono::duration<double> elapsed = Clock::now() - start;
+		double n = count;
+		printf("%-34s %10.0f %7.1f %7.2f %7.2f\n",name,n / elapsed.count(),
+			(double)bytes,(bus.transactions - transactions) / n,(bus.words - words) / n);
+	}
+};
+
+int main ( int argc, char *argv[] ) {
+	uint32_t iterations = argc > 1 ? strtoul(argv[1],NULL,0) : 20000UL;
+	int master, slave;
+	if ( !OpenPty(master,slave) ) {
+		perror("pty");
+		return 1;
+	}
+	deviceFd = slave;
+
+	AD9833 gen(bus);
+	AD9833Remote remote(gen,DeviceWrite);
+	gen.Begin();
+	std::thread device(Device,&remote);
+
+	AD9833Client board;
+	board.Attach(master);
+	int status = board.Ping();
+	if ( status != REMOTE_OK ) {
+		fprintf(stderr,"no answer from the device thread (%d)\n",status);
+		running = false;
+		device.join();
+		return 1;
+	}
+
+	// Round trip latency
+	std::vector<double> latency;
+	for ( uint32_t i = 0; i < iterations / 4; i++ ) {
+		Clock::time_point start = Clock::now();
+		status |= board.Ping();
+		latency.push_back(std::chrono::duration<double,std::micro>(
+			Clock::now() - start).count());
+	}
+	std::sort(latency.begin(),latency.end());
+	printf("PING round trip: median %.1f usec, p99 %.1f usec, max %.1f usec\n\n",
+		latency[latency.size() / 2],latency[latency.size() * 99 / 100],latency.back());
+
+	printf("%-34s %10s %7s %7s %7s\n","command","per second","bytes","SPI tx","words");
+	{
+		Row row;
+		for ( uint32_t i = 0; i < iterations; i++ )
+			status |= board.SetFrequencyWord(REG0,0x10000 + i);
+		row.Print("SetFrequencyWord, with reply",iterations,9);
+	}
+	{
+		Row row;
+		for ( uint32_t i = 0; i < iterations; i++ )
+			board.SetFrequencyWord(REG0,0x10000 + i,false);
+		status |= board.Ping();
+		row.Print("SetFrequencyWord, no reply",iterations,9);
+	}
+	{
+		// Retune: both frequencies, a phase and the output select
+		Row row;
+		for ( uint32_t i = 0; i < iterations; i++ ) {
+			board.SetFrequencyWord(REG0,0x10000 + i,false);
+			board.SetFrequencyWord(REG1,0x20000 + i,false);
+			board.SetPhaseWord(REG1,i & 0x0FFF,false);
+			board.SetOutputSource(i & 1 ? REG1 : REG0,SAME_AS_REG0,false);
+		}
+		status |= board.Ping();
+		row.Print("4 commands, no reply",iterations,9 + 9 + 7 + 6);
+	}
+	{
+		Row row;
+		for ( uint32_t i = 0; i < iterations; i++ ) {
+			board.BeginBatch();
+			board.SetFrequencyWord(REG0,0x10000 + i);
+			board.SetFrequencyWord(REG1,0x20000 + i);
+			board.SetPhaseWord(REG1,i & 0x0FFF);
+			board.SetOutputSource(i & 1 ? REG1 : REG0);
+			board.CommitBatch(false);
+		}
+		status |= board.Ping();
+		row.Print("the same 4 as one BATCH, no reply",iterations,4 + 6 + 6 + 4 + 3);
+	}
+	{
+		Row row;
+		for ( uint32_t i = 0; i < iterations; i++ ) {
+			board.BeginBatch();
+			board.SetFrequencyWord(REG0,0x10000 + i);
+			board.SetFrequencyWord(REG1,0x20000 + i);
+			board.SetPhaseWord(REG1,i & 0x0FFF);
+			board.SetOutputSource(i & 1 ? REG1 : REG0);
+			status |= board.CommitBatch();
+		}
+		row.Print("the same BATCH, with reply",iterations,4 + 6 + 6 + 4 + 3);
+	}
+
+	running = false;
+	device.join();
+	printf("\nframes applied %u, rejected %u, bytes lost %u, reply errors %u\n",
+		remote.framesApplied,remote.framesRejected,remote.bytesLost,board.replyErrors);
+	if ( status != REMOTE_OK ) fprintf(stderr,"a command failed\n");
+	return status == REMOTE_OK && remote.framesRejected == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/*
+ * spidev_bench.cpp
+ *
+ * System calls per update for the spidev transport. Run it against the
+ * LD_PRELOAD stand-in (make bench), or on a board with an AD9833 on
+ * /dev/spidev0.0:
+ *
+ *   ./spidev_bench [iterations] [device]
+ *
+ * Columns:
+ *   updates/s	updates per second, including the ioctl
+ *   words		16-bit SPI words per update
+ *   syscalls	ioctls per update (one SPI_IOC_MESSAGE per update)
+ *   per byte	system calls a port writing one byte per call would make
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <AD9833.h>
+#include "AD9833Spidev.h"
+
+/*
+ * Passes words on to the spidev transport and counts them
+ */
+class CountingTransport : public AD9833Transport {
+public:
+	CountingTransport ( AD9833Spidev &bus ) : bus(bus), words(0) { }
+	void Begin ( void ) { bus.Begin(); }
+	bool Write ( const uint16_t *w, uint8_t count ) {
+		words += count;
+		return bus.Write(w,count);
+	}
+	AD9833Spidev	&bus;
+	uint32_t		words;
+};
+
+typedef void (*UpdateFunc) ( AD9833 &gen, uint32_t i );
+
+static void ApplySignal ( AD9833 &gen, uint32_t i ) {
+	gen.ApplySignal(i & 1 ? SQUARE_WAVE : SINE_WAVE,REG0,
+		1000.0 + (i & 1023),SAME_AS_REG0,i % 360);
+}
+
+static void SetFrequency ( AD9833 &gen, uint32_t i ) {
+	gen.SetFrequency(REG0,1000.0 + (i & 1023));
+}
+
+static void SetPhase ( AD9833 &gen, uint32_t i ) {
+	gen.SetPhase(REG1,i % 360);
+}
+
+static void BatchedUpdate ( AD9833 &gen, uint32_t i ) {
+	gen.BeginUpdate();
+	gen.SetFrequency(REG0,1000.0 + (i & 1023));
+	gen.SetFrequency(REG1,2000.0 + (i & 1023));
+	gen.SetPhase(REG1,i % 360);
+	gen.SetOutputSource(i & 1 ? REG1 : REG0);
+	gen.CommitUpdate();
+}
+
+static const struct {
+	const char		*name;
+	UpdateFunc		func;
+} updates[] = {
+	{ "ApplySignal",				ApplySignal },
+	{ "SetFrequency",				SetFrequency },
+	{ "SetPhase",					SetPhase },
+	{ "BeginUpdate..CommitUpdate",	BatchedUpdate },
+};
+
+int main ( int argc, char *argv[] ) {
+	uint32_t iterations = argc > 1 ? strtoul(argv[1],NULL,0) : 100000UL;
+	const char *device = argc > 2 ? argv[2] : SPIDEV_DEFAULT_DEVICE;
+
+	AD9833Spidev bus(device);
+	CountingTransport counter(bus);
+	AD9833 gen(counter);
+
+	gen.Begin();
+	if ( !bus.IsOpen() ) {
+		fprintf(stderr,"%s: %s\n",device,strerror(bus.GetError()));
+		return 1;
+	}
+	gen.EnableOutput(true);
+
+	printf("%-28s %12s %7s %9s %9s\n","update","updates/s","words",
+		"syscalls","per byte");
+	for ( size_t u = 0; u < sizeof(updates) / sizeof(updates[0]); u++ ) {
+		uint32_t syscalls = bus.GetSyscalls();
+		counter.words = 0;
+		std::chrono::steady_clock::time_point start =
+			std::chrono::steady_clock::now();
+		for ( uint32_t i = 0; i < iterations; i++ )
+			updates[u].func(gen,i);
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - start;
+		double n = iterations;
+		printf("%-28s %12.0f %7.2f %9.2f %9.2f\n",updates[u].name,
+			n / elapsed.count(),counter.words / n,
+			(bus.GetSyscalls() - syscalls) / n,2.0 * counter.words / n);
+	}
+	if ( bus.GetError() )
+		fprintf(stderr,"%s: %s\n",device,strerror(bus.GetError()));
+	return bus.GetError() ? 1 : 0;
+}
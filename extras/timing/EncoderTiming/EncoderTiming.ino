@@ -0,0 +1,95 @@
+/*
+ * EncoderTiming.ino
+ *
+ * Times the frequency word encoder on an AVR board: the CPU cycles of
+ * one FrequencyToWord (the integer reciprocal encoder SetFrequency
+ * uses) against the float formula it replaced, counted by Timer1 at
+ * the CPU clock with interrupts off. Upload it and open the serial
+ * monitor at 115200 baud. Timer1 is taken over, so no PWM on pins 9
+ * and 10 while it runs. Needs no AD9833.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ */
+
+#include <AD9833.h>
+
+#ifndef __AVR__
+#error "EncoderTiming counts cycles with Timer1, so it is for AVR boards."
+#endif
+
+#define CALLS 1000          // Frequencies from 1 Hz to about 12 MHz
+
+AD9833 gen(10);             // Never begun: only its encoder is used
+
+volatile float input;       // Keep the compiler from folding the calls
+volatile uint32_t output;
+
+// As SetFrequency did it before the reciprocal encoder
+static uint32_t __attribute__((noinline)) FloatWord ( float frequency ) {
+    return (uint32_t)((frequency * 268435456.0) / 25000000.0) & FREQ_WORD_MASK;
+}
+
+static uint32_t __attribute__((noinline)) LibraryWord ( float frequency ) {
+    return gen.FrequencyToWord(frequency);
+}
+
+// The call and the timing alone, taken off the others
+static uint32_t __attribute__((noinline)) NoWord ( float frequency ) {
+    (void)frequency;
+    return 0;
+}
+
+// Average cycles of one call, and how many words differ from the library's
+static float Time ( uint32_t (*encode)( float ), uint16_t *off ) {
+    uint32_t total = 0;
+    float frequency = 1.0;
+    *off = 0;
+    for ( uint16_t i = 0; i < CALLS; i++ ) {
+        input = frequency;
+        float f = input;
+        noInterrupts();
+        TCNT1 = 0;
+        uint32_t word = encode(f);
+        uint16_t cycles = TCNT1;
+        interrupts();
+        output = word;
+        total += cycles;
+        if ( encode != NoWord && word != gen.FrequencyToWord(f) ) (*off)++;
+        frequency *= 1.0164;
+    }
+    return (float)total / CALLS;
+}
+
+void setup() {
+    Serial.begin(115200);
+    while ( !Serial ) ;
+
+    TCCR1A = 0;                     // Normal mode, counts to 0xFFFF
+    TCCR1B = _BV(CS10);             // CPU clock, no prescaler
+
+    uint16_t off;
+    float overhead = Time(NoWord,&off);
+    float floatCycles = Time(FloatWord,&off) - overhead;
+    uint16_t floatOff = off;
+    float libraryCycles = Time(LibraryWord,&off) - overhead;
+
+    Serial.print(F("Frequency word, CPU cycles per call at "));
+    Serial.print(F_CPU / 1000000UL);
+    Serial.println(F(" MHz, 25 MHz reference"));
+    Serial.print(F("  float (frequency * 2^28 / ref)  "));
+    Serial.print(floatCycles,1);
+    Serial.print(F("   "));
+    Serial.print(floatOff);
+    Serial.print(F(" / "));
+    Serial.print(CALLS);
+    Serial.println(F(" words differ from the library's"));
+    Serial.print(F("  integer reciprocal (library)    "));
+    Serial.println(libraryCycles,1);
+    Serial.print(F("  float minus integer             "));
+    Serial.println(floatCycles - libraryCycles,1);
+}
+
+void loop() {
+}